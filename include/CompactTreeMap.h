@@ -0,0 +1,853 @@
+#ifndef AISDI_MAPS_COMPACTTREEMAP_H
+#define AISDI_MAPS_COMPACTTREEMAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace aisdi
+{
+
+// AVL map with a compact node layout for large numbers of small entries.
+// Nodes live in one contiguous arena and refer to each other by 32-bit indices, the balance factor
+// is packed into the top bits of the child indices and the parent index is optional.
+// Without parent links iterators find the neighbouring node by searching from the root, O(log n).
+// Inserting may reallocate the arena, which invalidates references and pointers to entries, though not
+// iterators, which hold indices; reserve() beforehand to keep them. Removing moves the last node of the
+// arena into the freed slot, so removal invalidates iterators and references alike.
+template <typename KeyType, typename ValueType, bool ParentLinks = false>
+class CompactTreeMap
+{
+public:
+  using key_type = KeyType;
+  using mapped_type = ValueType;
+  using value_type = std::pair<key_type, mapped_type>;
+  using size_type = std::size_t;
+  using reference = value_type &;
+  using const_reference = const value_type &;
+
+  class ConstIterator;
+  class Iterator;
+  using iterator = Iterator;
+  using const_iterator = ConstIterator;
+
+private:
+  using index_type = std::uint32_t;
+
+  static constexpr index_type nil = 0x7fffffff;
+  static constexpr index_type heavyBit = 0x80000000;
+
+  struct NoParentLink
+  {
+  };
+
+  struct ParentLink
+  {
+    index_type parent = nil;
+  };
+
+  struct Node : std::conditional_t<ParentLinks, ParentLink, NoParentLink>
+  {
+    value_type value;
+    // left and right child; the top bit of the left index marks a left-heavy node,
+    // the top bit of the right index a right-heavy one
+    index_type children[2] = {nil, nil};
+
+    Node(value_type value)
+        : value(std::move(value)) {}
+  };
+
+  std::vector<Node> nodes;
+  index_type root = nil;
+
+  const key_type &getKey(index_type n) const
+  {
+    return nodes[n].value.first;
+  }
+
+  index_type left(index_type n) const
+  {
+    return nodes[n].children[0] & ~heavyBit;
+  }
+
+  index_type right(index_type n) const
+  {
+    return nodes[n].children[1] & ~heavyBit;
+  }
+
+  // height of the right subtree minus height of the left one
+  int balance(index_type n) const
+  {
+    return (nodes[n].children[1] & heavyBit ? 1 : 0) - (nodes[n].children[0] & heavyBit ? 1 : 0);
+  }
+
+  void setBalance(index_type n, int balance)
+  {
+    nodes[n].children[0] = (nodes[n].children[0] & ~heavyBit) | (balance < 0 ? heavyBit : 0);
+    nodes[n].children[1] = (nodes[n].children[1] & ~heavyBit) | (balance > 0 ? heavyBit : 0);
+  }
+
+  void setParent(index_type n, index_type parent)
+  {
+    if constexpr (ParentLinks)
+    {
+      if (n != nil)
+      {
+        nodes[n].parent = parent;
+      }
+    }
+  }
+
+  void setLeft(index_type n, index_type child)
+  {
+    nodes[n].children[0] = (nodes[n].children[0] & heavyBit) | child;
+    setParent(child, n);
+  }
+
+  void setRight(index_type n, index_type child)
+  {
+    nodes[n].children[1] = (nodes[n].children[1] & heavyBit) | child;
+    setParent(child, n);
+  }
+
+  index_type smallestNode(index_type n) const
+  {
+    if (n != nil)
+    {
+      while (left(n) != nil)
+      {
+        n = left(n);
+      }
+    }
+
+    return n;
+  }
+
+  index_type highestNode(index_type n) const
+  {
+    if (n != nil)
+    {
+      while (right(n) != nil)
+      {
+        n = right(n);
+      }
+    }
+
+    return n;
+  }
+
+  index_type successor(index_type n) const
+  {
+    if (right(n) != nil)
+    {
+      return smallestNode(right(n));
+    }
+
+    if constexpr (ParentLinks)
+    {
+      while (nodes[n].parent != nil && n != left(nodes[n].parent))
+      {
+        n = nodes[n].parent;
+      }
+
+      return nodes[n].parent;
+    }
+    else
+    {
+      // the successor is the last node at which the search for n turns left
+      index_type candidate = nil;
+
+      for (index_type current = root; current != n;)
+      {
+        if (getKey(n) < getKey(current))
+        {
+          candidate = current;
+          current = left(current);
+        }
+        else
+        {
+          current = right(current);
+        }
+      }
+
+      return candidate;
+    }
+  }
+
+  index_type predecessor(index_type n) const
+  {
+    if (left(n) != nil)
+    {
+      return highestNode(left(n));
+    }
+
+    if constexpr (ParentLinks)
+    {
+      while (nodes[n].parent != nil && n != right(nodes[n].parent))
+      {
+        n = nodes[n].parent;
+      }
+
+      return nodes[n].parent;
+    }
+    else
+    {
+      index_type candidate = nil;
+
+      for (index_type current = root; current != n;)
+      {
+        if (getKey(current) < getKey(n))
+        {
+          candidate = current;
+          current = right(current);
+        }
+        else
+        {
+          current = left(current);
+        }
+      }
+
+      return candidate;
+    }
+  }
+
+  index_type findNode(const key_type &key) const
+  {
+    index_type current = root;
+
+    while (current != nil)
+    {
+      if (key == getKey(current))
+      {
+        break;
+      }
+
+      // indexing the children instead of branching lets the compiler pick the child without a jump
+      current = nodes[current].children[getKey(current) < key] & ~heavyBit;
+    }
+
+    return current;
+  }
+
+  index_type newNode(const key_type &key)
+  {
+    if (nodes.size() >= nil)
+    {
+      throw std::length_error("CompactTreeMap is full!");
+    }
+
+    nodes.emplace_back(value_type(key, mapped_type()));
+
+    return static_cast<index_type>(nodes.size() - 1);
+  }
+
+  // right rotation, returns the new subtree root; balance factors are set by the caller
+  index_type LL(index_type n)
+  {
+    index_type m = left(n);
+
+    setLeft(n, right(m));
+    setRight(m, n);
+
+    return m;
+  }
+
+  // left rotation, returns the new subtree root; balance factors are set by the caller
+  index_type RR(index_type n)
+  {
+    index_type m = right(n);
+
+    setRight(n, left(m));
+    setLeft(m, n);
+
+    return m;
+  }
+
+  // n's left subtree is two levels higher than its right one
+  index_type fixLeftHeavy(index_type n, bool &heightReduced)
+  {
+    index_type l = left(n);
+    int lBalance = balance(l);
+
+    if (lBalance <= 0)
+    {
+      index_type m = LL(n);
+
+      setBalance(n, lBalance == 0 ? -1 : 0);
+      setBalance(l, lBalance == 0 ? 1 : 0);
+      heightReduced = (lBalance != 0);
+
+      return m;
+    }
+
+    index_type lr = right(l);
+    int lrBalance = balance(lr);
+
+    setLeft(n, RR(l));
+    index_type m = LL(n);
+
+    setBalance(n, lrBalance < 0 ? 1 : 0);
+    setBalance(l, lrBalance > 0 ? -1 : 0);
+    setBalance(lr, 0);
+    heightReduced = true;
+
+    return m;
+  }
+
+  // n's right subtree is two levels higher than its left one
+  index_type fixRightHeavy(index_type n, bool &heightReduced)
+  {
+    index_type r = right(n);
+    int rBalance = balance(r);
+
+    if (rBalance >= 0)
+    {
+      index_type m = RR(n);
+
+      setBalance(n, rBalance == 0 ? 1 : 0);
+      setBalance(r, rBalance == 0 ? -1 : 0);
+      heightReduced = (rBalance != 0);
+
+      return m;
+    }
+
+    index_type rl = left(r);
+    int rlBalance = balance(rl);
+
+    setRight(n, LL(r));
+    index_type m = RR(n);
+
+    setBalance(n, rlBalance > 0 ? -1 : 0);
+    setBalance(r, rlBalance < 0 ? 1 : 0);
+    setBalance(rl, 0);
+    heightReduced = true;
+
+    return m;
+  }
+
+  // returns the new subtree root, found is set to the node holding key
+  index_type insert(index_type n, const key_type &key, index_type &found, bool &grew)
+  {
+    if (n == nil)
+    {
+      found = newNode(key);
+      grew = true;
+      return found;
+    }
+
+    bool unused;
+
+    if (key < getKey(n))
+    {
+      index_type child = insert(left(n), key, found, grew);
+      setLeft(n, child);
+
+      if (grew)
+      {
+        int nBalance = balance(n);
+
+        if (nBalance >= 0)
+        {
+          setBalance(n, nBalance - 1);
+          grew = (nBalance == 0);
+        }
+        else
+        {
+          n = fixLeftHeavy(n, unused);
+          grew = false;
+        }
+      }
+    }
+    else if (getKey(n) < key)
+    {
+      index_type child = insert(right(n), key, found, grew);
+      setRight(n, child);
+
+      if (grew)
+      {
+        int nBalance = balance(n);
+
+        if (nBalance <= 0)
+        {
+          setBalance(n, nBalance + 1);
+          grew = (nBalance == 0);
+        }
+        else
+        {
+          n = fixRightHeavy(n, unused);
+          grew = false;
+        }
+      }
+    }
+    else
+    {
+      found = n;
+      grew = false;
+    }
+
+    return n;
+  }
+
+  index_type leftShrunk(index_type n, bool &shrunk)
+  {
+    int nBalance = balance(n);
+
+    if (nBalance <= 0)
+    {
+      setBalance(n, nBalance + 1);
+      shrunk = (nBalance < 0);
+      return n;
+    }
+
+    return fixRightHeavy(n, shrunk);
+  }
+
+  index_type rightShrunk(index_type n, bool &shrunk)
+  {
+    int nBalance = balance(n);
+
+    if (nBalance >= 0)
+    {
+      setBalance(n, nBalance - 1);
+      shrunk = (nBalance > 0);
+      return n;
+    }
+
+    return fixLeftHeavy(n, shrunk);
+  }
+
+  // unlinks the smallest node of the subtree without freeing its slot
+  index_type removeSmallest(index_type n, index_type &smallest, bool &shrunk)
+  {
+    if (left(n) == nil)
+    {
+      smallest = n;
+      shrunk = true;
+      return right(n);
+    }
+
+    setLeft(n, removeSmallest(left(n), smallest, shrunk));
+
+    return shrunk ? leftShrunk(n, shrunk) : n;
+  }
+
+  // unlinks the node holding key without freeing its slot, key must be present
+  index_type remove(index_type n, const key_type &key, index_type &removed, bool &shrunk)
+  {
+    if (key < getKey(n))
+    {
+      setLeft(n, remove(left(n), key, removed, shrunk));
+      return shrunk ? leftShrunk(n, shrunk) : n;
+    }
+
+    if (getKey(n) < key)
+    {
+      setRight(n, remove(right(n), key, removed, shrunk));
+      return shrunk ? rightShrunk(n, shrunk) : n;
+    }
+
+    removed = n;
+
+    if (left(n) == nil || right(n) == nil)
+    {
+      shrunk = true;
+      return left(n) == nil ? right(n) : left(n);
+    }
+
+    // the successor node takes n's place, so no value is moved
+    index_type replacement;
+    index_type rChild = removeSmallest(right(n), replacement, shrunk);
+
+    setLeft(replacement, left(n));
+    setRight(replacement, rChild);
+    setBalance(replacement, balance(n));
+
+    return shrunk ? rightShrunk(replacement, shrunk) : replacement;
+  }
+
+  // frees the slot of an unlinked node by moving the last node of the arena into it
+  void release(index_type n)
+  {
+    index_type last = static_cast<index_type>(nodes.size() - 1);
+
+    if (n != last)
+    {
+      index_type owner = nil;
+
+      if constexpr (ParentLinks)
+      {
+        owner = nodes[last].parent;
+      }
+      else
+      {
+        for (index_type current = root; current != last;)
+        {
+          owner = current;
+          current = getKey(last) < getKey(current) ? left(current) : right(current);
+        }
+      }
+
+      nodes[n] = std::move(nodes[last]);
+
+      if (owner == nil)
+      {
+        root = n;
+      }
+      else if (left(owner) == last)
+      {
+        setLeft(owner, n);
+      }
+      else
+      {
+        setRight(owner, n);
+      }
+
+      setParent(left(n), n);
+      setParent(right(n), n);
+    }
+
+    nodes.pop_back();
+  }
+
+public:
+  CompactTreeMap() = default;
+
+  CompactTreeMap(std::initializer_list<value_type> list)
+  {
+    nodes.reserve(list.size());
+
+    for (const auto &[key, value] : list)
+    {
+      (*this)[key] = value;
+    }
+  }
+
+  CompactTreeMap(const CompactTreeMap &) = default;
+
+  CompactTreeMap(CompactTreeMap &&other)
+      : nodes(std::move(other.nodes)), root(std::exchange(other.root, nil))
+  {
+    other.nodes.clear();
+  }
+
+  CompactTreeMap &operator=(const CompactTreeMap &) = default;
+
+  CompactTreeMap &operator=(CompactTreeMap &&other)
+  {
+    if (this != &other)
+    {
+      nodes = std::move(other.nodes);
+      root = std::exchange(other.root, nil);
+      other.nodes.clear();
+    }
+
+    return *this;
+  }
+
+  bool isEmpty() const
+  {
+    return nodes.empty();
+  }
+
+  size_type getSize() const
+  {
+    return nodes.size();
+  }
+
+  // Preallocates the arena, so inserting up to count entries does not reallocate.
+  void reserve(size_type count)
+  {
+    nodes.reserve(count);
+  }
+
+  // Releases arena slack left by growth or removals.
+  void shrinkToFit()
+  {
+    nodes.shrink_to_fit();
+  }
+
+  // Bytes held by the arena, including unused capacity but not memory owned by keys or values.
+  size_type getArenaBytes() const
+  {
+    return nodes.capacity() * sizeof(Node);
+  }
+
+  // The reference is valid until the next insertion that reallocates the arena or the next removal.
+  mapped_type &operator[](const key_type &key)
+  {
+    index_type found = nil;
+    bool grew = false;
+
+    root = insert(root, key, found, grew);
+    setParent(root, nil);
+
+    return nodes[found].value.second;
+  }
+
+  const mapped_type &valueOf(const key_type &key) const
+  {
+    index_type result = findNode(key);
+
+    if (result == nil)
+    {
+      throw std::out_of_range("Value not found!");
+    }
+
+    return nodes[result].value.second;
+  }
+
+  mapped_type &valueOf(const key_type &key)
+  {
+    index_type result = findNode(key);
+
+    if (result == nil)
+    {
+      throw std::out_of_range("Trying to get value of non-existing element!");
+    }
+
+    return nodes[result].value.second;
+  }
+
+  const_iterator find(const key_type &key) const
+  {
+    return const_iterator(this, findNode(key));
+  }
+
+  iterator find(const key_type &key)
+  {
+    return iterator(const_iterator(this, findNode(key)));
+  }
+
+  void remove(const key_type &key)
+  {
+    if (findNode(key) == nil)
+    {
+      throw std::out_of_range("Removing non-existing element!");
+    }
+
+    index_type removed = nil;
+    bool shrunk = false;
+
+    root = remove(root, key, removed, shrunk);
+    setParent(root, nil);
+    release(removed);
+  }
+
+  void remove(const const_iterator &it)
+  {
+    key_type key = it->first;
+    remove(key);
+  }
+
+  bool operator==(const CompactTreeMap &other) const
+  {
+    if (getSize() != other.getSize())
+    {
+      return false;
+    }
+
+    for (auto it = begin(), itOther = other.begin(); it != end(); ++it, ++itOther)
+    {
+      if (*it != *itOther)
+      {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  bool operator!=(const CompactTreeMap &other) const
+  {
+    return !(*this == other);
+  }
+
+  iterator begin()
+  {
+    return iterator(cbegin());
+  }
+
+  iterator end()
+  {
+    return iterator(cend());
+  }
+
+  const_iterator cbegin() const
+  {
+    return const_iterator(this, smallestNode(root));
+  }
+
+  const_iterator cend() const
+  {
+    return const_iterator(this, nil);
+  }
+
+  const_iterator begin() const
+  {
+    return cbegin();
+  }
+
+  const_iterator end() const
+  {
+    return cend();
+  }
+};
+
+template <typename KeyType, typename ValueType, bool ParentLinks>
+class CompactTreeMap<KeyType, ValueType, ParentLinks>::ConstIterator
+{
+public:
+  using reference = typename CompactTreeMap::const_reference;
+  using iterator_category = std::bidirectional_iterator_tag;
+  using value_type = typename CompactTreeMap::value_type;
+  using difference_type = std::ptrdiff_t;
+  using pointer = const typename CompactTreeMap::value_type *;
+  using key_type = typename CompactTreeMap::key_type;
+  using mapped_type = typename CompactTreeMap::mapped_type;
+
+private:
+  const CompactTreeMap *map = nullptr;
+  index_type index = nil;
+
+public:
+  ConstIterator() = default;
+
+  explicit ConstIterator(const CompactTreeMap *map, index_type index)
+      : map(map), index(index) {}
+
+  ConstIterator &operator++()
+  {
+    if (index == nil)
+    {
+      throw std::out_of_range("Incrementing end()");
+    }
+
+    index = map->successor(index);
+
+    return *this;
+  }
+
+  ConstIterator operator++(int)
+  {
+    auto tmp = *this;
+    operator++();
+    return tmp;
+  }
+
+  ConstIterator &operator--()
+  {
+    if (map->root == nil)
+    {
+      throw std::out_of_range("Decrementing iterator of an empty tree!");
+    }
+
+    if (index == nil)
+    {
+      index = map->highestNode(map->root);
+      return *this;
+    }
+
+    index_type previous = map->predecessor(index);
+
+    if (previous == nil)
+    {
+      throw std::out_of_range("Decrementing begin()!");
+    }
+
+    index = previous;
+
+    return *this;
+  }
+
+  ConstIterator operator--(int)
+  {
+    auto tmp = *this;
+    operator--();
+    return tmp;
+  }
+
+  reference operator*() const
+  {
+    if (index == nil)
+    {
+      throw std::out_of_range("Dereferencing end()!");
+    }
+
+    return map->nodes[index].value;
+  }
+
+  pointer operator->() const
+  {
+    return &this->operator*();
+  }
+
+  bool operator==(const ConstIterator &other) const
+  {
+    return map == other.map && index == other.index;
+  }
+
+  bool operator!=(const ConstIterator &other) const
+  {
+    return !(*this == other);
+  }
+};
+
+template <typename KeyType, typename ValueType, bool ParentLinks>
+class CompactTreeMap<KeyType, ValueType, ParentLinks>::Iterator : public CompactTreeMap<KeyType, ValueType, ParentLinks>::ConstIterator
+{
+public:
+  using reference = typename CompactTreeMap::reference;
+  using pointer = typename CompactTreeMap::value_type *;
+
+  Iterator() = default;
+
+  Iterator(const ConstIterator &other)
+      : ConstIterator(other)
+  {
+  }
+
+  Iterator &operator++()
+  {
+    ConstIterator::operator++();
+    return *this;
+  }
+
+  Iterator operator++(int)
+  {
+    auto result = *this;
+    ConstIterator::operator++();
+    return result;
+  }
+
+  Iterator &operator--()
+  {
+    ConstIterator::operator--();
+    return *this;
+  }
+
+  Iterator operator--(int)
+  {
+    auto result = *this;
+    ConstIterator::operator--();
+    return result;
+  }
+
+  pointer operator->() const
+  {
+    return &this->operator*();
+  }
+
+  reference operator*() const
+  {
+    return const_cast<reference>(ConstIterator::operator*());
+  }
+};
+
+} // namespace aisdi
+
+#endif /* AISDI_MAPS_COMPACTTREEMAP_H */
@@ -0,0 +1,546 @@
+#ifndef AISDI_MAPS_CONCURRENTSKIPLISTMAP_H
+#define AISDI_MAPS_CONCURRENTSKIPLISTMAP_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+
+#include "EpochReclamation.h"
+
+namespace aisdi
+{
+
+// Lock-free ordered map (Herlihy-Shavit skip list with Fraser-style marked links).
+// All operations may be called concurrently. Removed nodes and replaced values are
+// reclaimed through an EpochManager, so readers never touch freed memory.
+// Values are returned by copy, since a reference could be replaced by a concurrent upsert.
+template <typename KeyType, typename ValueType>
+class ConcurrentSkipListMap
+{
+public:
+  using key_type = KeyType;
+  using mapped_type = ValueType;
+  using value_type = std::pair<key_type, mapped_type>;
+  using size_type = std::size_t;
+  using reference = value_type &;
+  using const_reference = const value_type &;
+
+  class ConstIterator;
+  using iterator = ConstIterator;
+  using const_iterator = ConstIterator;
+
+private:
+  static constexpr int maxLevel = 24;
+
+  // the tower of next links is allocated right behind the node, so a hop touches one allocation
+  struct Node
+  {
+    union
+    {
+      key_type key; // not constructed for the head sentinel
+    };
+
+    std::atomic<mapped_type *> value;
+    int topLevel;
+    std::atomic<int> retireVotes{0};
+    std::atomic<std::uintptr_t> *next; // lowest bit marks the node as logically removed
+
+    static void *operator new(std::size_t size, int topLevel)
+    {
+      return ::operator new(size + (topLevel + 1) * sizeof(std::atomic<std::uintptr_t>));
+    }
+
+    static void operator delete(void *p, int)
+    {
+      ::operator delete(p);
+    }
+
+    static void operator delete(void *p)
+    {
+      ::operator delete(p);
+    }
+
+    explicit Node(int topLevel)
+        : value(nullptr), topLevel(topLevel), next(makeTower(topLevel)) {}
+
+    Node(const key_type &key, mapped_type *value, int topLevel)
+        : key(key), value(value), topLevel(topLevel), next(makeTower(topLevel)) {}
+
+    ~Node()
+    {
+      if (mapped_type *current = value.load())
+      {
+        key.~key_type();
+        delete current;
+      }
+    }
+
+    std::atomic<std::uintptr_t> *makeTower(int topLevel)
+    {
+      auto *tower = reinterpret_cast<std::atomic<std::uintptr_t> *>(this + 1);
+
+      for (int level = 0; level <= topLevel; ++level)
+      {
+        new (tower + level) std::atomic<std::uintptr_t>(0);
+      }
+
+      return tower;
+    }
+  };
+
+  mutable EpochManager epochs;
+  Node *head;
+  std::atomic<std::ptrdiff_t> size{0};
+
+  static Node *pointer(std::uintptr_t link)
+  {
+    return reinterpret_cast<Node *>(link & ~std::uintptr_t(1));
+  }
+
+  static bool isMarked(std::uintptr_t link)
+  {
+    return link & 1;
+  }
+
+  static std::uintptr_t makeLink(Node *n, bool marked = false)
+  {
+    return reinterpret_cast<std::uintptr_t>(n) | std::uintptr_t(marked);
+  }
+
+  static int randomLevel()
+  {
+    thread_local std::uint64_t state = 0x9E3779B97F4A7C15ull ^ reinterpret_cast<std::uintptr_t>(&state);
+
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+
+    int level = 0;
+
+    for (std::uint64_t bits = state; (bits & 1) && level < maxLevel - 1; bits >>= 1)
+    {
+      ++level;
+    }
+
+    return level;
+  }
+
+  // Fills preds/succs with the neighbours of key on every level, unlinking marked nodes on the way.
+  bool find(const key_type &key, Node **preds, Node **succs) const
+  {
+  retry:
+    Node *pred = head;
+
+    for (int level = maxLevel - 1; level >= 0; --level)
+    {
+      Node *current = pointer(pred->next[level].load());
+
+      while (current)
+      {
+        std::uintptr_t successor = current->next[level].load();
+
+        while (isMarked(successor))
+        {
+          std::uintptr_t expected = makeLink(current);
+
+          if (!pred->next[level].compare_exchange_strong(expected, makeLink(pointer(successor))))
+          {
+            goto retry;
+          }
+
+          current = pointer(successor);
+
+          if (current == nullptr)
+          {
+            break;
+          }
+
+          successor = current->next[level].load();
+        }
+
+        if (current == nullptr || !(current->key < key))
+        {
+          break;
+        }
+
+        pred = current;
+        current = pointer(successor);
+      }
+
+      preds[level] = pred;
+      succs[level] = current;
+    }
+
+    return succs[0] && !(key < succs[0]->key);
+  }
+
+  // both the inserting and the removing thread vote once they can no longer link the node,
+  // the second vote means the node is unreachable for any new traversal
+  void voteForRetirement(Node *n) const
+  {
+    if (n->retireVotes.fetch_add(1) == 1)
+    {
+      epochs.retire(n);
+    }
+  }
+
+  Node *firstNotRemoved(Node *n) const
+  {
+    while (n && isMarked(n->next[0].load()))
+    {
+      n = pointer(n->next[0].load());
+    }
+
+    return n;
+  }
+
+public:
+  ConcurrentSkipListMap()
+      : head(new (maxLevel - 1) Node(maxLevel - 1))
+  {
+    for (int level = 0; level < maxLevel; ++level)
+    {
+      head->next[level].store(makeLink(nullptr));
+    }
+  }
+
+  ConcurrentSkipListMap(std::initializer_list<value_type> list)
+      : ConcurrentSkipListMap()
+  {
+    for (const auto &[key, value] : list)
+    {
+      upsert(key, value);
+    }
+  }
+
+  ConcurrentSkipListMap(const ConcurrentSkipListMap &) = delete;
+  ConcurrentSkipListMap &operator=(const ConcurrentSkipListMap &) = delete;
+
+  // No other thread may access the map any more.
+  ~ConcurrentSkipListMap()
+  {
+    Node *current = head;
+
+    while (current)
+    {
+      Node *next = pointer(current->next[0].load());
+      delete current;
+      current = next;
+    }
+  }
+
+  bool isEmpty() const
+  {
+    return getSize() == 0;
+  }
+
+  // Exact when no operation is in progress.
+  size_type getSize() const
+  {
+    std::ptrdiff_t current = size.load();
+    return current > 0 ? current : 0;
+  }
+
+  // Inserts key or replaces its value, returns true if the key was not present.
+  bool upsert(const key_type &key, const mapped_type &value)
+  {
+    EpochManager::Guard guard(epochs);
+
+    Node *preds[maxLevel];
+    Node *succs[maxLevel];
+    int topLevel = randomLevel();
+
+    while (true)
+    {
+      if (find(key, preds, succs))
+      {
+        mapped_type *replaced = succs[0]->value.exchange(new mapped_type(value));
+        epochs.retire(replaced);
+        return false;
+      }
+
+      Node *newNode = new (topLevel) Node(key, new mapped_type(value), topLevel);
+
+      for (int level = 0; level <= topLevel; ++level)
+      {
+        newNode->next[level].store(makeLink(succs[level]));
+      }
+
+      std::uintptr_t expected = makeLink(succs[0]);
+
+      if (!preds[0]->next[0].compare_exchange_strong(expected, makeLink(newNode)))
+      {
+        delete newNode;
+        continue;
+      }
+
+      ++size;
+
+      for (int level = 1; level <= topLevel; ++level)
+      {
+        while (true)
+        {
+          std::uintptr_t own = newNode->next[level].load();
+
+          if (isMarked(own))
+          {
+            level = topLevel; // removed in the meantime, stop linking
+            break;
+          }
+
+          if (pointer(own) != succs[level] &&
+              !newNode->next[level].compare_exchange_strong(own, makeLink(succs[level])))
+          {
+            continue;
+          }
+
+          expected = makeLink(succs[level]);
+
+          if (preds[level]->next[level].compare_exchange_strong(expected, makeLink(newNode)))
+          {
+            break;
+          }
+
+          if (!find(key, preds, succs) || succs[0] != newNode)
+          {
+            level = topLevel;
+            break;
+          }
+        }
+      }
+
+      // a level linked after a concurrent removal has to be unlinked again
+      if (isMarked(newNode->next[0].load()))
+      {
+        find(key, preds, succs);
+      }
+
+      voteForRetirement(newNode);
+
+      return true;
+    }
+  }
+
+  void remove(const key_type &key)
+  {
+    EpochManager::Guard guard(epochs);
+
+    Node *preds[maxLevel];
+    Node *succs[maxLevel];
+
+    while (true)
+    {
+      if (!find(key, preds, succs))
+      {
+        throw std::out_of_range("Removing non-existing element!");
+      }
+
+      Node *victim = succs[0];
+
+      for (int level = victim->topLevel; level >= 1; --level)
+      {
+        std::uintptr_t successor = victim->next[level].load();
+
+        while (!isMarked(successor))
+        {
+          victim->next[level].compare_exchange_weak(successor, successor | 1);
+        }
+      }
+
+      std::uintptr_t successor = victim->next[0].load();
+
+      while (!isMarked(successor))
+      {
+        if (victim->next[0].compare_exchange_strong(successor, successor | 1))
+        {
+          --size;
+          find(key, preds, succs);
+          voteForRetirement(victim);
+          return;
+        }
+      }
+
+      // removed by another thread first, look again
+    }
+  }
+
+  void remove(const const_iterator &it)
+  {
+    remove(it->first);
+  }
+
+  bool contains(const key_type &key) const
+  {
+    EpochManager::Guard guard(epochs);
+
+    Node *preds[maxLevel];
+    Node *succs[maxLevel];
+
+    return find(key, preds, succs);
+  }
+
+  mapped_type valueOf(const key_type &key) const
+  {
+    EpochManager::Guard guard(epochs);
+
+    Node *preds[maxLevel];
+    Node *succs[maxLevel];
+
+    if (!find(key, preds, succs))
+    {
+      throw std::out_of_range("Value not found!");
+    }
+
+    return *succs[0]->value.load();
+  }
+
+  const_iterator find(const key_type &key) const
+  {
+    const_iterator it = lowerBound(key);
+
+    if (it != cend() && key < it->first)
+    {
+      return cend();
+    }
+
+    return it;
+  }
+
+  // First item with key not smaller than key.
+  const_iterator lowerBound(const key_type &key) const
+  {
+    const_iterator it(this, nullptr);
+
+    Node *preds[maxLevel];
+    Node *succs[maxLevel];
+    find(key, preds, succs);
+
+    it.moveTo(firstNotRemoved(succs[0]));
+
+    return it;
+  }
+
+  // Calls function(key, value) for keys in [from, to) in order, sees a weakly consistent view.
+  template <typename Function>
+  void scan(const key_type &from, const key_type &to, Function function) const
+  {
+    for (auto it = lowerBound(from); it != cend() && it->first < to; ++it)
+    {
+      function(it->first, it->second);
+    }
+  }
+
+  const_iterator cbegin() const
+  {
+    const_iterator it(this, nullptr);
+    it.moveTo(firstNotRemoved(pointer(head->next[0].load())));
+
+    return it;
+  }
+
+  const_iterator cend() const
+  {
+    return const_iterator(this, nullptr);
+  }
+
+  const_iterator begin() const
+  {
+    return cbegin();
+  }
+
+  const_iterator end() const
+  {
+    return cend();
+  }
+};
+
+// Forward iterator which tolerates concurrent modification: it never visits a removed node twice
+// nor freed memory, and sees every item present during the whole traversal.
+// It pins an epoch while alive, so it must stay on the thread that created it and should be short-lived.
+template <typename KeyType, typename ValueType>
+class ConcurrentSkipListMap<KeyType, ValueType>::ConstIterator
+{
+public:
+  using reference = typename ConcurrentSkipListMap::const_reference;
+  using iterator_category = std::forward_iterator_tag;
+  using value_type = typename ConcurrentSkipListMap::value_type;
+  using difference_type = std::ptrdiff_t;
+  using pointer = const typename ConcurrentSkipListMap::value_type *;
+
+private:
+  friend class ConcurrentSkipListMap;
+
+  const ConcurrentSkipListMap *map;
+  EpochManager::Guard guard;
+  Node *actualNode;
+  std::optional<value_type> current; // copy taken when the iterator arrived at actualNode
+
+  ConstIterator(const ConcurrentSkipListMap *map, Node *actualNode)
+      : map(map), guard(map->epochs), actualNode(actualNode) {}
+
+  void moveTo(Node *n)
+  {
+    actualNode = n;
+    current.reset();
+
+    if (actualNode)
+    {
+      current.emplace(actualNode->key, *actualNode->value.load());
+    }
+  }
+
+public:
+  ConstIterator &operator++()
+  {
+    if (actualNode == nullptr)
+    {
+      throw std::out_of_range("Incrementing end()");
+    }
+
+    moveTo(map->firstNotRemoved(ConcurrentSkipListMap::pointer(actualNode->next[0].load())));
+
+    return *this;
+  }
+
+  ConstIterator operator++(int)
+  {
+    auto tmp = *this;
+    operator++();
+    return tmp;
+  }
+
+  reference operator*() const
+  {
+    if (actualNode == nullptr)
+    {
+      throw std::out_of_range("Dereferencing end()!");
+    }
+
+    return *current;
+  }
+
+  pointer operator->() const
+  {
+    return &this->operator*();
+  }
+
+  bool operator==(const ConstIterator &other) const
+  {
+    return map == other.map && actualNode == other.actualNode;
+  }
+
+  bool operator!=(const ConstIterator &other) const
+  {
+    return !(*this == other);
+  }
+};
+
+} // namespace aisdi
+
+#endif /* AISDI_MAPS_CONCURRENTSKIPLISTMAP_H */
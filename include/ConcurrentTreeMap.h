@@ -0,0 +1,800 @@
+#ifndef AISDI_MAPS_CONCURRENTTREEMAP_H
+#define AISDI_MAPS_CONCURRENTTREEMAP_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "EpochReclamation.h"
+
+namespace aisdi
+{
+
+// AVL map for many concurrent readers and some writers using optimistic lock coupling.
+// Every node carries a version which a writer makes odd while it changes the node's links.
+// Readers never write shared memory: they descend remembering versions and restart whenever
+// a version they depend on has changed, so they are never blocked by each other.
+// forEach reads the same way, one descent from the root per entry, so a scan costs O(n log n) rather
+// than O(n) and each of its steps restarts when a writer changes the path it took.
+// Writers descend the same way and lock only the nodes whose links or value they change, taking a lock
+// only if the node's version is still the one they read, so they never wait for each other and restart
+// on a conflict. Rebalancing goes back up the path locking the parent, the node and the rotated children,
+// always top-down, and stops at the first node whose height did not change; a writer finding a node on
+// its path moved by another one finds the node's new parent and goes on from there.
+// A removed key whose node has two children leaves a routing node without a value behind,
+// as in Bronson et al., so keys never move between nodes; routing nodes are unlinked once
+// they have at most one child.
+template <typename KeyType, typename ValueType>
+class ConcurrentTreeMap
+{
+public:
+  using key_type = KeyType;
+  using mapped_type = ValueType;
+  using value_type = std::pair<key_type, mapped_type>;
+  using size_type = std::size_t;
+
+private:
+  struct Node
+  {
+    union
+    {
+      const key_type key; // not constructed for the holder sentinel
+    };
+
+    std::atomic<mapped_type *> value; // nullptr for routing nodes
+    std::atomic<std::uint64_t> version{0};
+    std::atomic<Node *> lChild{nullptr};
+    std::atomic<Node *> rChild{nullptr};
+    int height = 1;         // changed with the node and its parent locked
+    bool unlinked = false;  // set and read with the node locked
+    bool isHolder;
+
+    Node()
+        : value(nullptr), isHolder(true) {}
+
+    Node(const key_type &key, mapped_type *value)
+        : key(key), value(value), isHolder(false) {}
+
+    ~Node()
+    {
+      if (!isHolder)
+      {
+        key.~key_type();
+      }
+
+      delete value.load();
+    }
+  };
+
+  // the root hangs as the right child of the holder, so replacing it is an ordinary link change
+  Node *holder = new Node();
+  mutable EpochManager epochs;
+  std::atomic<size_type> size{0};
+
+  // a node on a writer's path with the version it had when passed
+  struct Step
+  {
+    Node *node;
+    std::uint64_t version;
+  };
+
+  // locks n if it is unlocked and still has the given version, i.e. has not changed since it was read
+  static bool tryLock(Node *n, std::uint64_t version)
+  {
+    return (version & 1) == 0 && n->version.compare_exchange_strong(version, version + 1, std::memory_order_acq_rel);
+  }
+
+  static bool tryLock(Node *n)
+  {
+    return tryLock(n, n->version.load(std::memory_order_relaxed));
+  }
+
+  static void unlock(Node *n)
+  {
+    n->version.fetch_add(1, std::memory_order_release);
+  }
+
+  static std::uint64_t stableVersion(Node *n)
+  {
+    std::uint64_t version = n->version.load(std::memory_order_acquire);
+
+    while (version & 1)
+    {
+      version = n->version.load(std::memory_order_acquire);
+    }
+
+    return version;
+  }
+
+  static bool isValid(Node *n, std::uint64_t version)
+  {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return n->version.load(std::memory_order_relaxed) == version;
+  }
+
+  // Optimistic descent, calls found(node) on the node holding key (or nullptr) while it is still valid.
+  template <typename Found>
+  auto read(const key_type &key, Found found) const
+  {
+    EpochManager::Guard guard(epochs);
+
+    while (true)
+    {
+      Node *current = holder;
+      std::uint64_t version = stableVersion(current);
+      Node *child = current->rChild.load(std::memory_order_acquire);
+      bool restart = false;
+
+      while (true)
+      {
+        if (!isValid(current, version))
+        {
+          restart = true;
+          break;
+        }
+
+        if (child == nullptr)
+        {
+          break;
+        }
+
+        std::uint64_t childVersion = stableVersion(child);
+
+        // the parent still links to child, so child's version was read while it was in the tree
+        if (!isValid(current, version))
+        {
+          restart = true;
+          break;
+        }
+
+        current = child;
+        version = childVersion;
+
+        if (key < current->key)
+        {
+          child = current->lChild.load(std::memory_order_acquire);
+        }
+        else if (current->key < key)
+        {
+          child = current->rChild.load(std::memory_order_acquire);
+        }
+        else
+        {
+          auto result = found(current);
+
+          if (isValid(current, version))
+          {
+            return result;
+          }
+
+          restart = true;
+          break;
+        }
+      }
+
+      if (!restart)
+      {
+        return found(nullptr);
+      }
+    }
+  }
+
+  // Optimistic descent of a writer: path gets the nodes from the holder down to the node holding key
+  // (found is set) or the one key would hang below, with their versions; false when it has to restart.
+  bool descend(const key_type &key, std::vector<Step> &path, bool &found) const
+  {
+    path.clear();
+    found = false;
+
+    Node *current = holder;
+    std::uint64_t version = stableVersion(current);
+    Node *child = current->rChild.load(std::memory_order_acquire);
+    path.push_back({current, version});
+
+    while (child)
+    {
+      std::uint64_t childVersion = stableVersion(child);
+
+      if (!isValid(current, version))
+      {
+        return false;
+      }
+
+      current = child;
+      version = childVersion;
+      path.push_back({current, version});
+
+      if (key < current->key)
+      {
+        child = current->lChild.load(std::memory_order_acquire);
+      }
+      else if (current->key < key)
+      {
+        child = current->rChild.load(std::memory_order_acquire);
+      }
+      else
+      {
+        found = true;
+        break;
+      }
+    }
+
+    return true;
+  }
+
+  static int height(Node *n)
+  {
+    return n ? n->height : 0;
+  }
+
+  static void updateHeight(Node *n)
+  {
+    n->height = std::max(height(n->lChild.load()), height(n->rChild.load())) + 1;
+  }
+
+  static int heightDifference(Node *n)
+  {
+    return n ? height(n->lChild.load()) - height(n->rChild.load()) : 0;
+  }
+
+  // right rotation of n, which hangs on link; the caller holds the locks of link's owner, n and its left child
+  static Node *LL(std::atomic<Node *> &link, Node *n)
+  {
+    Node *m = n->lChild.load();
+    Node *o = m->rChild.load();
+
+    n->lChild.store(o, std::memory_order_release);
+    m->rChild.store(n, std::memory_order_release);
+    link.store(m, std::memory_order_release);
+
+    updateHeight(n);
+    updateHeight(m);
+
+    return m;
+  }
+
+  // left rotation of n, which hangs on link; the caller holds the locks of link's owner, n and its right child
+  static Node *RR(std::atomic<Node *> &link, Node *n)
+  {
+    Node *m = n->rChild.load();
+    Node *o = m->lChild.load();
+
+    n->rChild.store(o, std::memory_order_release);
+    m->lChild.store(n, std::memory_order_release);
+    link.store(m, std::memory_order_release);
+
+    updateHeight(n);
+    updateHeight(m);
+
+    return m;
+  }
+
+  enum class Repair
+  {
+    unchanged, // n kept its height, nothing above needs repair
+    changed,   // n was unlinked, rotated or changed its height, owner is next
+    conflict,  // a lock was taken, try again
+    moved      // owner no longer links to n, n's new parent is next
+  };
+
+  static bool isRedundant(Node *n)
+  {
+    return n->value.load() == nullptr && (n->lChild.load() == nullptr || n->rChild.load() == nullptr);
+  }
+
+  // Unlinks n if it is a routing node with at most one child, otherwise updates its height and
+  // rotates it if its children differ in height by two; rotated-down routing nodes left with at most
+  // one child are added to demoted.
+  Repair repair(Node *owner, Node *n, std::vector<Node *> &demoted)
+  {
+    if (!tryLock(owner))
+    {
+      return Repair::conflict;
+    }
+
+    if (owner->unlinked || (owner->lChild.load() != n && owner->rChild.load() != n))
+    {
+      unlock(owner);
+      return Repair::moved;
+    }
+
+    if (!tryLock(n))
+    {
+      unlock(owner);
+      return Repair::conflict;
+    }
+
+    std::atomic<Node *> &link = owner->lChild.load() == n ? owner->lChild : owner->rChild;
+    Node *left = n->lChild.load();
+    Node *right = n->rChild.load();
+
+    if (isRedundant(n))
+    {
+      link.store(left ? left : right, std::memory_order_release);
+      n->unlinked = true;
+
+      unlock(n);
+      unlock(owner);
+      epochs.retire(n);
+
+      return Repair::changed;
+    }
+
+    int balance = height(left) - height(right);
+
+    if (balance >= -1 && balance <= 1)
+    {
+      int oldHeight = n->height;
+      updateHeight(n);
+      bool heightChanged = n->height != oldHeight;
+
+      unlock(n);
+      unlock(owner);
+
+      return heightChanged ? Repair::changed : Repair::unchanged;
+    }
+
+    // the taller child comes up, or its inner child if that one is the taller of the two
+    Node *m = balance > 1 ? left : right;
+
+    if (!tryLock(m))
+    {
+      unlock(n);
+      unlock(owner);
+      return Repair::conflict;
+    }
+
+    Node *o = nullptr;
+
+    if (balance > 1 ? heightDifference(m) < 0 : heightDifference(m) > 0)
+    {
+      o = balance > 1 ? m->rChild.load() : m->lChild.load();
+
+      if (!tryLock(o))
+      {
+        unlock(m);
+        unlock(n);
+        unlock(owner);
+        return Repair::conflict;
+      }
+
+      if (balance > 1)
+      {
+        RR(n->lChild, m);
+      }
+      else
+      {
+        LL(n->rChild, m);
+      }
+    }
+
+    if (balance > 1)
+    {
+      LL(link, n);
+    }
+    else
+    {
+      RR(link, n);
+    }
+
+    if (isRedundant(n))
+    {
+      demoted.push_back(n);
+    }
+
+    if (o && isRedundant(m))
+    {
+      demoted.push_back(m);
+    }
+
+    if (o)
+    {
+      unlock(o);
+    }
+
+    unlock(m);
+    unlock(n);
+    unlock(owner);
+
+    return Repair::changed;
+  }
+
+  // the path down to n where it is linked now, false when it is not linked any more
+  bool relocate(Node *n, std::vector<Step> &path) const
+  {
+    bool found = false;
+
+    while (!descend(n->key, path, found))
+    {
+    }
+
+    return found && path.back().node == n;
+  }
+
+  // Repairs the nodes of path bottom-up, from its last node to the root. A node moved by another writer
+  // may have had its height computed before this writer's change below it, so it is repaired again
+  // under its new parent; an unlinked one was repaired above by the writer that unlinked it.
+  void repairUp(std::vector<Step> &path, std::vector<Node *> &demoted)
+  {
+    for (std::size_t i = path.size() - 1; i > 0;)
+    {
+      Repair result;
+
+      while ((result = repair(path[i - 1].node, path[i].node, demoted)) == Repair::conflict)
+      {
+        std::this_thread::yield();
+      }
+
+      if (result == Repair::unchanged)
+      {
+        return;
+      }
+
+      if (result == Repair::moved)
+      {
+        if (!relocate(path[i].node, path))
+        {
+          return;
+        }
+
+        i = path.size() - 1;
+        continue;
+      }
+
+      --i;
+    }
+  }
+
+  // repairs up from the end of path, then from every routing node rotations left to be unlinked
+  void rebalance(std::vector<Step> &path)
+  {
+    std::vector<Node *> demoted;
+    repairUp(path, demoted);
+
+    while (!demoted.empty())
+    {
+      Node *n = demoted.back();
+      demoted.pop_back();
+
+      if (relocate(n, path))
+      {
+        repairUp(path, demoted);
+      }
+    }
+  }
+
+  // The entry with the smallest key greater than after (than none if nullptr), found by a validated
+  // descent which goes on from any routing node it ends at.
+  std::optional<value_type> entryAfter(const key_type *after) const
+  {
+    EpochManager::Guard guard(epochs);
+    std::optional<key_type> bound;
+
+    if (after)
+    {
+      bound = *after;
+    }
+
+    while (true)
+    {
+      Node *current = holder;
+      std::uint64_t version = stableVersion(current);
+      Node *child = current->rChild.load(std::memory_order_acquire);
+      Node *candidate = nullptr;
+      std::uint64_t candidateVersion = 0;
+      bool restart = false;
+
+      while (child)
+      {
+        std::uint64_t childVersion = stableVersion(child);
+
+        if (!isValid(current, version))
+        {
+          restart = true;
+          break;
+        }
+
+        current = child;
+        version = childVersion;
+
+        if (!bound || *bound < current->key)
+        {
+          candidate = current;
+          candidateVersion = version;
+          child = current->lChild.load(std::memory_order_acquire);
+        }
+        else
+        {
+          child = current->rChild.load(std::memory_order_acquire);
+        }
+      }
+
+      if (restart || !isValid(current, version))
+      {
+        continue;
+      }
+
+      if (candidate == nullptr)
+      {
+        return std::nullopt;
+      }
+
+      mapped_type *value = candidate->value.load(std::memory_order_acquire);
+
+      if (value == nullptr)
+      {
+        if (isValid(candidate, candidateVersion))
+        {
+          bound = candidate->key;
+        }
+
+        continue;
+      }
+
+      value_type entry(candidate->key, *value);
+
+      if (isValid(candidate, candidateVersion))
+      {
+        return entry;
+      }
+    }
+  }
+
+#ifndef NDEBUG
+  // checks n's subtree, whose keys lie between lower and upper (nullptr for no bound), returns its height
+  int checkSubtree(Node *n, const key_type *lower, const key_type *upper, size_type &values) const
+  {
+    if (!n)
+    {
+      return 0;
+    }
+
+    if ((lower && !(*lower < n->key)) || (upper && !(n->key < *upper)))
+    {
+      throw std::logic_error("Keys are not in increasing order");
+    }
+
+    if (isRedundant(n))
+    {
+      throw std::logic_error("Routing node with fewer than two children is still linked");
+    }
+
+    int left = checkSubtree(n->lChild.load(), lower, &n->key, values);
+    int right = checkSubtree(n->rChild.load(), &n->key, upper, values);
+
+    if (n->height != std::max(left, right) + 1)
+    {
+      throw std::logic_error("Height is not one more than the children's");
+    }
+
+    if (left - right > 1 || right - left > 1)
+    {
+      throw std::logic_error("Children differ in height by more than one");
+    }
+
+    values += n->value.load() != nullptr;
+
+    return n->height;
+  }
+#endif
+
+  static void removeTree(Node *n)
+  {
+    if (n)
+    {
+      removeTree(n->lChild.load());
+      removeTree(n->rChild.load());
+      delete n;
+    }
+  }
+
+public:
+  ConcurrentTreeMap() = default;
+
+  ConcurrentTreeMap(std::initializer_list<value_type> list)
+  {
+    for (const auto &[key, value] : list)
+    {
+      upsert(key, value);
+    }
+  }
+
+  ConcurrentTreeMap(const ConcurrentTreeMap &) = delete;
+  ConcurrentTreeMap &operator=(const ConcurrentTreeMap &) = delete;
+
+  // No other thread may access the map any more.
+  ~ConcurrentTreeMap()
+  {
+    removeTree(holder);
+  }
+
+#ifndef NDEBUG
+  // For tests, with no writer running: throws std::logic_error naming the first broken invariant of
+  // the key order, heights, balance, routing nodes or size.
+  void checkInvariants() const
+  {
+    size_type values = 0;
+    checkSubtree(holder->rChild.load(), nullptr, nullptr, values);
+
+    if (values != size.load())
+    {
+      throw std::logic_error("Size differs from the number of values");
+    }
+  }
+#endif
+
+  bool isEmpty() const
+  {
+    return getSize() == 0;
+  }
+
+  size_type getSize() const
+  {
+    return size.load();
+  }
+
+  // Inserts key or replaces its value, returns true if the key was not present.
+  bool upsert(const key_type &key, const mapped_type &value)
+  {
+    EpochManager::Guard guard(epochs);
+    std::vector<Step> path;
+    bool found = false;
+
+    // allocated before taking a lock and kept across restarts
+    mapped_type *newValue = new mapped_type(value);
+    Node *newNode = nullptr;
+
+    while (true)
+    {
+      if (!descend(key, path, found))
+      {
+        continue;
+      }
+
+      auto [n, version] = path.back();
+
+      if (!found && !newNode)
+      {
+        newNode = new Node(key, newValue);
+      }
+
+      if (!tryLock(n, version))
+      {
+        std::this_thread::yield();
+        continue;
+      }
+
+      if (found)
+      {
+        // also revives a routing node, which is never unlinked while it is locked
+        mapped_type *replaced = n->value.exchange(newValue);
+        unlock(n);
+
+        if (newNode)
+        {
+          newNode->value.store(nullptr);
+          delete newNode;
+        }
+
+        if (replaced)
+        {
+          epochs.retire(replaced);
+          return false;
+        }
+
+        ++size;
+        return true;
+      }
+
+      std::atomic<Node *> &link = (n == holder || n->key < key) ? n->rChild : n->lChild;
+      link.store(newNode, std::memory_order_release);
+      unlock(n);
+
+      ++size;
+      rebalance(path);
+
+      return true;
+    }
+  }
+
+  void remove(const key_type &key)
+  {
+    EpochManager::Guard guard(epochs);
+    std::vector<Step> path;
+    bool found = false;
+
+    while (true)
+    {
+      if (!descend(key, path, found))
+      {
+        continue;
+      }
+
+      auto [n, version] = path.back();
+
+      if (!found)
+      {
+        if (!isValid(n, version))
+        {
+          continue;
+        }
+
+        throw std::out_of_range("Removing non-existing element!");
+      }
+
+      if (!tryLock(n, version))
+      {
+        std::this_thread::yield();
+        continue;
+      }
+
+      mapped_type *value = n->value.exchange(nullptr);
+      unlock(n);
+
+      if (value == nullptr)
+      {
+        throw std::out_of_range("Removing non-existing element!");
+      }
+
+      epochs.retire(value);
+      --size;
+      rebalance(path);
+
+      return;
+    }
+  }
+
+  bool contains(const key_type &key) const
+  {
+    return read(key, [](Node *n) { return n && n->value.load() != nullptr; });
+  }
+
+  std::optional<mapped_type> find(const key_type &key) const
+  {
+    return read(key, [](Node *n) -> std::optional<mapped_type> {
+      mapped_type *value = n ? n->value.load() : nullptr;
+
+      if (value == nullptr)
+      {
+        return std::nullopt;
+      }
+
+      return *value;
+    });
+  }
+
+  // Returns a copy, as the value may be replaced by a concurrent upsert.
+  mapped_type valueOf(const key_type &key) const
+  {
+    std::optional<mapped_type> result = find(key);
+
+    if (!result)
+    {
+      throw std::out_of_range("Value not found!");
+    }
+
+    return *result;
+  }
+
+  // Calls function(key, value) in key order with copies, one descent per entry, O(n log n), so that it
+  // may run alongside writers: it visits every key present all along, and others only if found on the way.
+  template <typename Function>
+  void forEach(Function function) const
+  {
+    for (std::optional<value_type> entry = entryAfter(nullptr); entry; entry = entryAfter(&entry->first))
+    {
+      function(entry->first, entry->second);
+    }
+  }
+};
+
+} // namespace aisdi
+
+#endif /* AISDI_MAPS_CONCURRENTTREEMAP_H */
@@ -0,0 +1,147 @@
+#ifndef AISDI_MAPS_COUNTED_H
+#define AISDI_MAPS_COUNTED_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+namespace aisdi
+{
+
+// What the maps did to Counted keys and values since the last reset; not thread-safe.
+struct OperationCounts
+{
+  std::uint64_t comparisons = 0; // <, == and !=
+  std::uint64_t hashes = 0;      // std::hash, AbslHashValue and the % HashMap hashes with
+  std::uint64_t copies = 0;      // copy constructions
+  std::uint64_t moves = 0;       // move constructions
+  std::uint64_t assignments = 0; // copy and move assignments
+  std::uint64_t destructions = 0;
+
+  static OperationCounts &current()
+  {
+    static OperationCounts counts;
+    return counts;
+  }
+
+  static void reset()
+  {
+    current() = OperationCounts();
+  }
+};
+
+inline OperationCounts operator-(const OperationCounts &after, const OperationCounts &before)
+{
+  OperationCounts difference;
+  difference.comparisons = after.comparisons - before.comparisons;
+  difference.hashes = after.hashes - before.hashes;
+  difference.copies = after.copies - before.copies;
+  difference.moves = after.moves - before.moves;
+  difference.assignments = after.assignments - before.assignments;
+  difference.destructions = after.destructions - before.destructions;
+  return difference;
+}
+
+// A T that counts the operations on it into OperationCounts::current(), to measure
+// how many comparisons, hashes and copies a map operation costs.
+template <typename T>
+class Counted
+{
+public:
+  Counted() = default;
+
+  Counted(T value)
+      : item(std::move(value)) {}
+
+  Counted(const Counted &other)
+      : item(other.item)
+  {
+    ++OperationCounts::current().copies;
+  }
+
+  Counted(Counted &&other) noexcept(std::is_nothrow_move_constructible_v<T>)
+      : item(std::move(other.item))
+  {
+    ++OperationCounts::current().moves;
+  }
+
+  ~Counted()
+  {
+    ++OperationCounts::current().destructions;
+  }
+
+  Counted &operator=(const Counted &other)
+  {
+    ++OperationCounts::current().assignments;
+    item = other.item;
+    return *this;
+  }
+
+  Counted &operator=(Counted &&other) noexcept(std::is_nothrow_move_assignable_v<T>)
+  {
+    ++OperationCounts::current().assignments;
+    item = std::move(other.item);
+    return *this;
+  }
+
+  const T &value() const
+  {
+    return item;
+  }
+
+  friend bool operator<(const Counted &a, const Counted &b)
+  {
+    ++OperationCounts::current().comparisons;
+    return a.item < b.item;
+  }
+
+  friend bool operator==(const Counted &a, const Counted &b)
+  {
+    ++OperationCounts::current().comparisons;
+    return a.item == b.item;
+  }
+
+  friend bool operator!=(const Counted &a, const Counted &b)
+  {
+    return !(a == b);
+  }
+
+  // the bucket HashMap puts an integral key in
+  template <typename U = T, typename = std::enable_if_t<std::is_integral_v<U>>>
+  friend std::size_t operator%(const Counted &key, std::size_t buckets)
+  {
+    ++OperationCounts::current().hashes;
+    return static_cast<std::size_t>(key.item) % buckets;
+  }
+
+  template <typename H>
+  friend H AbslHashValue(H state, const Counted &key)
+  {
+    ++OperationCounts::current().hashes;
+    return H::combine(std::move(state), key.item);
+  }
+
+private:
+  T item = T();
+};
+
+} // namespace aisdi
+
+namespace std
+{
+
+template <typename T>
+struct hash<aisdi::Counted<T>>
+{
+  std::size_t operator()(const aisdi::Counted<T> &key) const
+  {
+    ++aisdi::OperationCounts::current().hashes;
+    return std::hash<T>()(key.value());
+  }
+};
+
+} // namespace std
+
+#endif /* AISDI_MAPS_COUNTED_H */
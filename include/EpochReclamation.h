@@ -0,0 +1,223 @@
+#ifndef AISDI_MAPS_EPOCHRECLAMATION_H
+#define AISDI_MAPS_EPOCHRECLAMATION_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace aisdi
+{
+
+// Epoch-based memory reclamation for lock-free structures.
+// Threads pin the current epoch with a Guard while they may hold pointers into the structure.
+// A retired object is deleted once the global epoch has advanced twice since its retirement,
+// which can only happen after every thread pinned at that time has left its critical section.
+class EpochManager
+{
+private:
+  static constexpr std::uint64_t inactive = std::numeric_limits<std::uint64_t>::max();
+  static constexpr std::size_t reclaimThreshold = 64;
+
+  struct Retired
+  {
+    void *object;
+    void (*deleter)(void *);
+    std::uint64_t epoch;
+  };
+
+  // one per thread that used this manager, only the owning thread touches depth and retired;
+  // a thread that reuses the id of one that exited takes its record over
+  struct alignas(64) Record
+  {
+    std::atomic<std::uint64_t> epoch{inactive};
+    unsigned depth = 0;
+    std::vector<Retired> retired;
+    std::thread::id owner;
+    Record *next = nullptr;
+  };
+
+  std::atomic<std::uint64_t> globalEpoch{0};
+  std::atomic<Record *> records{nullptr};
+  const std::uint64_t id;
+
+  static std::uint64_t makeId()
+  {
+    static std::atomic<std::uint64_t> nextId{0};
+    return nextId++;
+  }
+
+  Record *localRecord()
+  {
+    // the record of the manager this thread used last, keyed by id rather than address, so a new
+    // manager at a reused address does not match; it holds one entry however many managers come and go
+    thread_local std::pair<std::uint64_t, Record *> last{std::numeric_limits<std::uint64_t>::max(), nullptr};
+
+    if (last.first == id)
+    {
+      return last.second;
+    }
+
+    std::thread::id self = std::this_thread::get_id();
+    Record *record = records.load();
+
+    while (record && record->owner != self)
+    {
+      record = record->next;
+    }
+
+    if (!record)
+    {
+      record = new Record;
+      record->owner = self;
+      record->next = records.load();
+
+      while (!records.compare_exchange_weak(record->next, record))
+      {
+      }
+    }
+
+    last = {id, record};
+
+    return record;
+  }
+
+  void pin(Record *record)
+  {
+    if (record->depth++ == 0)
+    {
+      record->epoch.store(globalEpoch.load());
+    }
+  }
+
+  void unpin(Record *record)
+  {
+    if (--record->depth == 0)
+    {
+      record->epoch.store(inactive);
+    }
+  }
+
+  bool tryAdvance()
+  {
+    std::uint64_t epoch = globalEpoch.load();
+
+    for (Record *record = records.load(); record; record = record->next)
+    {
+      std::uint64_t local = record->epoch.load();
+
+      if (local != inactive && local != epoch)
+      {
+        return false;
+      }
+    }
+
+    return globalEpoch.compare_exchange_strong(epoch, epoch + 1);
+  }
+
+  void reclaim(Record *record)
+  {
+    std::uint64_t epoch = globalEpoch.load();
+    auto &retired = record->retired;
+    std::size_t kept = 0;
+
+    for (std::size_t i = 0; i < retired.size(); ++i)
+    {
+      if (retired[i].epoch + 2 <= epoch)
+      {
+        retired[i].deleter(retired[i].object);
+      }
+      else
+      {
+        retired[kept++] = retired[i];
+      }
+    }
+
+    retired.resize(kept);
+  }
+
+public:
+  class Guard
+  {
+  private:
+    EpochManager *manager;
+    Record *record;
+
+  public:
+    explicit Guard(EpochManager &manager)
+        : manager(&manager), record(manager.localRecord())
+    {
+      this->manager->pin(record);
+    }
+
+    // copies must stay on the thread that created the original
+    Guard(const Guard &other)
+        : manager(other.manager), record(other.record)
+    {
+      manager->pin(record);
+    }
+
+    Guard &operator=(const Guard &other)
+    {
+      if (this != &other)
+      {
+        other.manager->pin(other.record);
+        manager->unpin(record);
+        manager = other.manager;
+        record = other.record;
+      }
+
+      return *this;
+    }
+
+    ~Guard()
+    {
+      manager->unpin(record);
+    }
+  };
+
+  EpochManager()
+      : id(makeId()) {}
+
+  EpochManager(const EpochManager &) = delete;
+  EpochManager &operator=(const EpochManager &) = delete;
+
+  // No thread may use the manager any more, everything still retired is deleted.
+  ~EpochManager()
+  {
+    Record *record = records.load();
+
+    while (record)
+    {
+      for (auto &item : record->retired)
+      {
+        item.deleter(item.object);
+      }
+
+      Record *next = record->next;
+      delete record;
+      record = next;
+    }
+  }
+
+  // Schedules object for deletion, it must already be unreachable for threads pinning from now on.
+  template <typename T>
+  void retire(T *object)
+  {
+    Record *record = localRecord();
+    record->retired.push_back({object, [](void *p) { delete static_cast<T *>(p); }, globalEpoch.load()});
+
+    if (record->retired.size() >= reclaimThreshold)
+    {
+      tryAdvance();
+      reclaim(record);
+    }
+  }
+};
+
+} // namespace aisdi
+
+#endif /* AISDI_MAPS_EPOCHRECLAMATION_H */
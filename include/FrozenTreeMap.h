@@ -0,0 +1,376 @@
+#ifndef AISDI_MAPS_FROZENTREEMAP_H
+#define AISDI_MAPS_FROZENTREEMAP_H
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace aisdi
+{
+
+// Immutable sorted map in Eytzinger (breadth-first) layout, usually obtained from TreeMap::freeze().
+// Position k holds the root of the implicit tree for k = 1 and the children of k live at 2k and 2k + 1,
+// so the top levels share a few cache lines and the descendants of a node several levels down are
+// adjacent in memory. Searches are branchless and prefetch those descendants ahead of time.
+// Keys are additionally kept in a separate dense array, which is all a search touches.
+// Compare is either a strict weak ordering or a three-way comparator, as for TreeMap.
+template <typename KeyType, typename ValueType, typename Compare = std::less<KeyType>>
+class FrozenTreeMap
+{
+public:
+  using key_type = KeyType;
+  using mapped_type = ValueType;
+  using key_compare = Compare;
+  using value_type = std::pair<key_type, mapped_type>;
+  using size_type = std::size_t;
+  using reference = value_type &;
+  using const_reference = const value_type &;
+
+  class ConstIterator;
+  using iterator = ConstIterator;
+  using const_iterator = ConstIterator;
+
+private:
+  // descendants prefetchStride levels down from k start at k * prefetchStride and fill a cache line
+  static constexpr size_type prefetchStride = std::max<size_type>(1, 64 / sizeof(key_type));
+
+  // both in Eytzinger order, position k (1-based) is stored at index k - 1
+  std::vector<key_type> keys;
+  std::vector<value_type> items;
+  Compare compare;
+
+  static constexpr bool isThreeWay =
+      !std::is_same_v<std::decay_t<std::invoke_result_t<const Compare &, const key_type &, const key_type &>>, bool>;
+
+  bool less(const key_type &a, const key_type &b) const
+  {
+    if constexpr (isThreeWay)
+    {
+      return compare(a, b) < 0;
+    }
+    else
+    {
+      return compare(a, b);
+    }
+  }
+
+  static const value_type &itemOf(const value_type &item)
+  {
+    return item;
+  }
+
+  static const value_type &itemOf(const value_type *item)
+  {
+    return *item;
+  }
+
+  // assigns sorted ranks to positions by an in-order walk of the implicit tree
+  void layout(std::vector<size_type> &order, size_type k, size_type &rank) const
+  {
+    if (k <= order.size())
+    {
+      layout(order, 2 * k, rank);
+      order[k - 1] = rank++;
+      layout(order, 2 * k + 1, rank);
+    }
+  }
+
+  const key_type &keyAt(size_type k) const
+  {
+    return keys[k - 1];
+  }
+
+  // position of the first key not less than key, 0 if there is none
+  size_type lowerBoundPosition(const key_type &key) const
+  {
+    const size_type n = keys.size();
+    const key_type *base = keys.data();
+    size_type k = 1;
+
+    while (k <= n)
+    {
+      __builtin_prefetch(base + std::min(k * prefetchStride, n) - 1);
+      k = 2 * k + less(base[k - 1], key);
+    }
+
+    // undo the trailing right turns and the final left turn, leaving the last node we went left at
+    return k >> __builtin_ffsll(~static_cast<long long>(k));
+  }
+
+  size_type firstPosition() const
+  {
+    size_type k = 0;
+
+    for (size_type next = 1; next <= items.size(); next *= 2)
+    {
+      k = next;
+    }
+
+    return k;
+  }
+
+  size_type lastPosition() const
+  {
+    size_type k = 0;
+
+    for (size_type next = 1; next <= items.size(); next = 2 * next + 1)
+    {
+      k = next;
+    }
+
+    return k;
+  }
+
+  size_type nextPosition(size_type k) const
+  {
+    if (2 * k + 1 <= items.size())
+    {
+      k = 2 * k + 1;
+
+      while (2 * k <= items.size())
+      {
+        k *= 2;
+      }
+
+      return k;
+    }
+
+    while (k & 1)
+    {
+      k >>= 1;
+    }
+
+    return k >> 1;
+  }
+
+  size_type previousPosition(size_type k) const
+  {
+    if (2 * k <= items.size())
+    {
+      k *= 2;
+
+      while (2 * k + 1 <= items.size())
+      {
+        k = 2 * k + 1;
+      }
+
+      return k;
+    }
+
+    while (k > 1 && !(k & 1))
+    {
+      k >>= 1;
+    }
+
+    return k >> 1;
+  }
+
+public:
+  FrozenTreeMap() = default;
+
+  // Keys in [first, last) must be strictly increasing. The range may hold values or pointers to values.
+  template <typename RandomIt>
+  FrozenTreeMap(RandomIt first, RandomIt last, const Compare &compare = Compare())
+      : compare(compare)
+  {
+    size_type count = std::distance(first, last);
+    std::vector<size_type> order(count);
+    size_type nextRank = 0;
+
+    layout(order, 1, nextRank);
+
+    keys.reserve(count);
+    items.reserve(count);
+
+    for (size_type rank : order)
+    {
+      items.push_back(itemOf(first[rank]));
+      keys.push_back(items.back().first);
+    }
+  }
+
+  bool isEmpty() const
+  {
+    return items.empty();
+  }
+
+  size_type getSize() const
+  {
+    return items.size();
+  }
+
+  bool contains(const key_type &key) const
+  {
+    size_type k = lowerBoundPosition(key);
+    return k != 0 && !less(key, keyAt(k));
+  }
+
+  const mapped_type &valueOf(const key_type &key) const
+  {
+    size_type k = lowerBoundPosition(key);
+
+    if (k == 0 || less(key, keyAt(k)))
+    {
+      throw std::out_of_range("Value not found!");
+    }
+
+    return items[k - 1].second;
+  }
+
+  const_iterator find(const key_type &key) const
+  {
+    size_type k = lowerBoundPosition(key);
+
+    if (k == 0 || less(key, keyAt(k)))
+    {
+      return cend();
+    }
+
+    return const_iterator(this, k);
+  }
+
+  // First item whose key is not less than key.
+  const_iterator lowerBound(const key_type &key) const
+  {
+    return const_iterator(this, lowerBoundPosition(key));
+  }
+
+  bool operator==(const FrozenTreeMap &other) const
+  {
+    return items == other.items;
+  }
+
+  bool operator!=(const FrozenTreeMap &other) const
+  {
+    return !(*this == other);
+  }
+
+  const_iterator cbegin() const
+  {
+    return const_iterator(this, firstPosition());
+  }
+
+  const_iterator cend() const
+  {
+    return const_iterator(this, 0);
+  }
+
+  const_iterator begin() const
+  {
+    return cbegin();
+  }
+
+  const_iterator end() const
+  {
+    return cend();
+  }
+};
+
+// Walks the implicit tree in order, amortised O(1) per step.
+template <typename KeyType, typename ValueType, typename Compare>
+class FrozenTreeMap<KeyType, ValueType, Compare>::ConstIterator
+{
+public:
+  using reference = typename FrozenTreeMap::const_reference;
+  using iterator_category = std::bidirectional_iterator_tag;
+  using value_type = typename FrozenTreeMap::value_type;
+  using difference_type = std::ptrdiff_t;
+  using pointer = const typename FrozenTreeMap::value_type *;
+  using key_type = typename FrozenTreeMap::key_type;
+  using mapped_type = typename FrozenTreeMap::mapped_type;
+
+private:
+  const FrozenTreeMap *map = nullptr;
+  size_type position = 0; // 0 for end()
+
+public:
+  ConstIterator() = default;
+
+  explicit ConstIterator(const FrozenTreeMap *map, size_type position)
+      : map(map), position(position) {}
+
+  ConstIterator &operator++()
+  {
+    if (position == 0)
+    {
+      throw std::out_of_range("Incrementing end()");
+    }
+
+    position = map->nextPosition(position);
+
+    return *this;
+  }
+
+  ConstIterator operator++(int)
+  {
+    auto tmp = *this;
+    operator++();
+    return tmp;
+  }
+
+  ConstIterator &operator--()
+  {
+    if (map->isEmpty())
+    {
+      throw std::out_of_range("Decrementing iterator of an empty tree!");
+    }
+
+    if (position == 0)
+    {
+      position = map->lastPosition();
+      return *this;
+    }
+
+    size_type previous = map->previousPosition(position);
+
+    if (previous == 0)
+    {
+      throw std::out_of_range("Decrementing begin()!");
+    }
+
+    position = previous;
+
+    return *this;
+  }
+
+  ConstIterator operator--(int)
+  {
+    auto tmp = *this;
+    operator--();
+    return tmp;
+  }
+
+  reference operator*() const
+  {
+    if (position == 0)
+    {
+      throw std::out_of_range("Dereferencing end()!");
+    }
+
+    return map->items[position - 1];
+  }
+
+  pointer operator->() const
+  {
+    return &this->operator*();
+  }
+
+  bool operator==(const ConstIterator &other) const
+  {
+    return map == other.map && position == other.position;
+  }
+
+  bool operator!=(const ConstIterator &other) const
+  {
+    return !(*this == other);
+  }
+};
+
+} // namespace aisdi
+
+#endif /* AISDI_MAPS_FROZENTREEMAP_H */
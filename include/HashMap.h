@@ -288,13 +288,18 @@ private:
     return key % (buckets * 2);
   }
 
+  // entries are spliced into their new buckets, nothing is copied or allocated but the bucket array
   void resize()
   {
     entry_list *newEntries = new entry_list[buckets * 2 + 1];
 
-    for (auto [key, value] : *this)
+    for (size_type index = 0; index < buckets; ++index)
     {
-      newEntries[reHash(key)].emplace_back(key, value);
+      while (!entries[index].empty())
+      {
+        entry_list &target = newEntries[reHash(entries[index].front().first)];
+        target.splice(target.end(), entries[index], entries[index].begin());
+      }
     }
 
     buckets *= 2;
@@ -0,0 +1,469 @@
+#ifndef AISDI_MAPS_PERSISTENTTREEMAP_H
+#define AISDI_MAPS_PERSISTENTTREEMAP_H
+
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace aisdi
+{
+
+// Immutable AVL map. insert() and remove() return a new version which shares all untouched
+// nodes with the old one (path copying), so copying a map is O(1) and old versions stay valid.
+// Nodes are reclaimed by reference counting once no version refers to them.
+template <typename KeyType, typename ValueType>
+class PersistentTreeMap
+{
+public:
+  using key_type = KeyType;
+  using mapped_type = ValueType;
+  using value_type = std::pair<key_type, mapped_type>;
+  using size_type = std::size_t;
+  using reference = value_type &;
+  using const_reference = const value_type &;
+
+  class ConstIterator;
+  using iterator = ConstIterator;
+  using const_iterator = ConstIterator;
+
+private:
+  struct Node;
+  using NodePtr = std::shared_ptr<const Node>;
+
+  struct Node
+  {
+    value_type value;
+    int height;
+    NodePtr lChild, rChild;
+
+    Node(value_type value, NodePtr lChild, NodePtr rChild)
+        : value(std::move(value)), height(std::max(heightOf(lChild), heightOf(rChild)) + 1),
+          lChild(std::move(lChild)), rChild(std::move(rChild)) {}
+  };
+
+  NodePtr root;
+  size_type size = 0;
+
+  PersistentTreeMap(NodePtr root, size_type size)
+      : root(std::move(root)), size(size) {}
+
+  static int heightOf(const NodePtr &n)
+  {
+    return n ? n->height : 0;
+  }
+
+  static NodePtr makeNode(value_type value, NodePtr lChild, NodePtr rChild)
+  {
+    return std::make_shared<const Node>(std::move(value), std::move(lChild), std::move(rChild));
+  }
+
+  // creates a node over two subtrees whose heights differ by at most two, rotating if needed
+  static NodePtr balance(value_type value, NodePtr lChild, NodePtr rChild)
+  {
+    int lHeight = heightOf(lChild);
+    int rHeight = heightOf(rChild);
+
+    if (lHeight > rHeight + 1)
+    {
+      if (heightOf(lChild->lChild) >= heightOf(lChild->rChild))
+      {
+        return makeNode(lChild->value, lChild->lChild,
+                        makeNode(std::move(value), lChild->rChild, std::move(rChild)));
+      }
+
+      const Node *middle = lChild->rChild.get();
+
+      return makeNode(middle->value,
+                      makeNode(lChild->value, lChild->lChild, middle->lChild),
+                      makeNode(std::move(value), middle->rChild, std::move(rChild)));
+    }
+
+    if (rHeight > lHeight + 1)
+    {
+      if (heightOf(rChild->rChild) >= heightOf(rChild->lChild))
+      {
+        return makeNode(rChild->value,
+                        makeNode(std::move(value), std::move(lChild), rChild->lChild),
+                        rChild->rChild);
+      }
+
+      const Node *middle = rChild->lChild.get();
+
+      return makeNode(middle->value,
+                      makeNode(std::move(value), std::move(lChild), middle->lChild),
+                      makeNode(rChild->value, middle->rChild, rChild->rChild));
+    }
+
+    return makeNode(std::move(value), std::move(lChild), std::move(rChild));
+  }
+
+  static NodePtr insert(const NodePtr &n, const key_type &key, const mapped_type &mapped, bool &added)
+  {
+    if (n == nullptr)
+    {
+      added = true;
+      return makeNode({key, mapped}, nullptr, nullptr);
+    }
+
+    if (key < n->value.first)
+    {
+      return balance(n->value, insert(n->lChild, key, mapped, added), n->rChild);
+    }
+
+    if (n->value.first < key)
+    {
+      return balance(n->value, n->lChild, insert(n->rChild, key, mapped, added));
+    }
+
+    return makeNode({key, mapped}, n->lChild, n->rChild);
+  }
+
+  static NodePtr removeSmallest(const NodePtr &n, value_type &smallest)
+  {
+    if (n->lChild == nullptr)
+    {
+      smallest = n->value;
+      return n->rChild;
+    }
+
+    return balance(n->value, removeSmallest(n->lChild, smallest), n->rChild);
+  }
+
+  static NodePtr remove(const NodePtr &n, const key_type &key)
+  {
+    if (key < n->value.first)
+    {
+      return balance(n->value, remove(n->lChild, key), n->rChild);
+    }
+
+    if (n->value.first < key)
+    {
+      return balance(n->value, n->lChild, remove(n->rChild, key));
+    }
+
+    if (n->lChild == nullptr)
+    {
+      return n->rChild;
+    }
+
+    if (n->rChild == nullptr)
+    {
+      return n->lChild;
+    }
+
+    value_type successor = n->value;
+    NodePtr rChild = removeSmallest(n->rChild, successor);
+
+    return balance(std::move(successor), n->lChild, std::move(rChild));
+  }
+
+  const Node *findNode(const key_type &key) const
+  {
+    const Node *current = root.get();
+
+    while (current)
+    {
+      if (key < current->value.first)
+      {
+        current = current->lChild.get();
+      }
+      else if (current->value.first < key)
+      {
+        current = current->rChild.get();
+      }
+      else
+      {
+        break;
+      }
+    }
+
+    return current;
+  }
+
+public:
+  PersistentTreeMap() = default;
+
+  PersistentTreeMap(std::initializer_list<value_type> list)
+  {
+    for (const auto &[key, value] : list)
+    {
+      *this = insert(key, value);
+    }
+  }
+
+  bool isEmpty() const
+  {
+    return !size;
+  }
+
+  size_type getSize() const
+  {
+    return size;
+  }
+
+  // Returns a new version with key mapped to value, O(log n) new nodes.
+  PersistentTreeMap insert(const key_type &key, const mapped_type &value) const
+  {
+    bool added = false;
+    NodePtr newRoot = insert(root, key, value, added);
+
+    return PersistentTreeMap(std::move(newRoot), added ? size + 1 : size);
+  }
+
+  // Returns a new version without key, O(log n) new nodes.
+  PersistentTreeMap remove(const key_type &key) const
+  {
+    if (findNode(key) == nullptr)
+    {
+      throw std::out_of_range("Removing non-existing element!");
+    }
+
+    return PersistentTreeMap(remove(root, key), size - 1);
+  }
+
+  PersistentTreeMap remove(const const_iterator &it) const
+  {
+    return remove(it->first);
+  }
+
+  const mapped_type &valueOf(const key_type &key) const
+  {
+    const Node *result = findNode(key);
+
+    if (result == nullptr)
+    {
+      throw std::out_of_range("Value not found!");
+    }
+
+    return result->value.second;
+  }
+
+  const_iterator find(const key_type &key) const
+  {
+    const Node *result = findNode(key);
+
+    if (result == nullptr)
+    {
+      return cend();
+    }
+
+    return const_iterator(this, key);
+  }
+
+  bool operator==(const PersistentTreeMap &other) const
+  {
+    if (size != other.size)
+    {
+      return false;
+    }
+
+    return std::equal(begin(), end(), other.begin());
+  }
+
+  bool operator!=(const PersistentTreeMap &other) const
+  {
+    return !(*this == other);
+  }
+
+  const_iterator cbegin() const
+  {
+    return const_iterator(this);
+  }
+
+  const_iterator cend() const
+  {
+    return const_iterator(root);
+  }
+
+  const_iterator begin() const
+  {
+    return cbegin();
+  }
+
+  const_iterator end() const
+  {
+    return cend();
+  }
+};
+
+// Keeps the iterated version alive, so it stays valid after the map it came from is reassigned.
+template <typename KeyType, typename ValueType>
+class PersistentTreeMap<KeyType, ValueType>::ConstIterator
+{
+public:
+  using reference = typename PersistentTreeMap::const_reference;
+  using iterator_category = std::bidirectional_iterator_tag;
+  using value_type = typename PersistentTreeMap::value_type;
+  using difference_type = std::ptrdiff_t;
+  using pointer = const typename PersistentTreeMap::value_type *;
+  using key_type = typename PersistentTreeMap::key_type;
+  using mapped_type = typename PersistentTreeMap::mapped_type;
+
+private:
+  friend class PersistentTreeMap;
+
+  NodePtr root;
+  std::vector<const Node *> path; // from root to the current node, empty for end()
+
+  explicit ConstIterator(NodePtr root)
+      : root(std::move(root)) {}
+
+  explicit ConstIterator(const PersistentTreeMap *map)
+      : root(map->root)
+  {
+    descendLeft(root.get());
+  }
+
+  ConstIterator(const PersistentTreeMap *map, const key_type &key)
+      : root(map->root)
+  {
+    const Node *current = root.get();
+
+    while (current)
+    {
+      path.push_back(current);
+
+      if (key < current->value.first)
+      {
+        current = current->lChild.get();
+      }
+      else if (current->value.first < key)
+      {
+        current = current->rChild.get();
+      }
+      else
+      {
+        break;
+      }
+    }
+  }
+
+  void descendLeft(const Node *n)
+  {
+    for (; n; n = n->lChild.get())
+    {
+      path.push_back(n);
+    }
+  }
+
+  void descendRight(const Node *n)
+  {
+    for (; n; n = n->rChild.get())
+    {
+      path.push_back(n);
+    }
+  }
+
+public:
+  ConstIterator &operator++()
+  {
+    if (path.empty())
+    {
+      throw std::out_of_range("Incrementing end()");
+    }
+
+    if (path.back()->rChild)
+    {
+      descendLeft(path.back()->rChild.get());
+      return *this;
+    }
+
+    const Node *child;
+
+    do
+    {
+      child = path.back();
+      path.pop_back();
+    } while (!path.empty() && path.back()->rChild.get() == child);
+
+    return *this;
+  }
+
+  ConstIterator operator++(int)
+  {
+    auto tmp = *this;
+    operator++();
+    return tmp;
+  }
+
+  ConstIterator &operator--()
+  {
+    if (root == nullptr)
+    {
+      throw std::out_of_range("Decrementing iterator of an empty tree!");
+    }
+
+    if (path.empty())
+    {
+      descendRight(root.get());
+      return *this;
+    }
+
+    if (path.back()->lChild)
+    {
+      descendRight(path.back()->lChild.get());
+      return *this;
+    }
+
+    std::vector<const Node *> previousPath = path;
+    const Node *child;
+
+    do
+    {
+      child = path.back();
+      path.pop_back();
+    } while (!path.empty() && path.back()->lChild.get() == child);
+
+    if (path.empty())
+    {
+      path = std::move(previousPath);
+      throw std::out_of_range("Decrementing begin()!");
+    }
+
+    return *this;
+  }
+
+  ConstIterator operator--(int)
+  {
+    auto tmp = *this;
+    operator--();
+    return tmp;
+  }
+
+  reference operator*() const
+  {
+    if (path.empty())
+    {
+      throw std::out_of_range("Dereferencing end()!");
+    }
+
+    return path.back()->value;
+  }
+
+  pointer operator->() const
+  {
+    return &this->operator*();
+  }
+
+  bool operator==(const ConstIterator &other) const
+  {
+    const Node *current = path.empty() ? nullptr : path.back();
+    const Node *otherCurrent = other.path.empty() ? nullptr : other.path.back();
+
+    return root == other.root && current == otherCurrent;
+  }
+
+  bool operator!=(const ConstIterator &other) const
+  {
+    return !(*this == other);
+  }
+};
+
+} // namespace aisdi
+
+#endif /* AISDI_MAPS_PERSISTENTTREEMAP_H */
@@ -0,0 +1,1507 @@
+#ifndef AISDI_MAPS_RADIXTREEMAP_H
+#define AISDI_MAPS_RADIXTREEMAP_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+namespace aisdi
+{
+
+// Byte string of a key whose lexicographic order is the order of the keys:
+// integers are stored big-endian with the sign bit flipped for signed types, strings as they are.
+template <typename KeyType, typename = void>
+class RadixKey;
+
+template <typename KeyType>
+class RadixKey<KeyType, std::enable_if_t<std::is_integral_v<KeyType>>>
+{
+  std::uint8_t bytes[sizeof(KeyType)];
+
+public:
+  explicit RadixKey(KeyType key)
+  {
+    using Unsigned = std::make_unsigned_t<KeyType>;
+    Unsigned bits = static_cast<Unsigned>(key);
+
+    if constexpr (std::is_signed_v<KeyType>)
+    {
+      bits ^= Unsigned(1) << (8 * sizeof(KeyType) - 1);
+    }
+
+    for (std::size_t i = 0; i < sizeof(KeyType); ++i)
+    {
+      bytes[i] = static_cast<std::uint8_t>(bits >> (8 * (sizeof(KeyType) - 1 - i)));
+    }
+  }
+
+  const std::uint8_t *data() const
+  {
+    return bytes;
+  }
+
+  std::size_t size() const
+  {
+    return sizeof(KeyType);
+  }
+
+  std::uint8_t operator[](std::size_t i) const
+  {
+    return bytes[i];
+  }
+};
+
+template <>
+class RadixKey<std::string>
+{
+  const std::string &key;
+
+public:
+  explicit RadixKey(const std::string &key)
+      : key(key) {}
+
+  const std::uint8_t *data() const
+  {
+    return reinterpret_cast<const std::uint8_t *>(key.data());
+  }
+
+  std::size_t size() const
+  {
+    return key.size();
+  }
+
+  std::uint8_t operator[](std::size_t i) const
+  {
+    return static_cast<std::uint8_t>(key[i]);
+  }
+};
+
+// Ordered map over the bytes of its keys, an adaptive radix tree (Leis et al.).
+// Inner nodes branch on one byte and grow from 4 to 16, 48 and 256 children as needed;
+// chains of single-child nodes are collapsed into a prefix stored in the node below
+// (the first maxPrefixLength bytes of it, longer prefixes are verified at the leaf).
+// A key that is a prefix of other keys is kept in the terminal slot of the node where it ends.
+// Leaves are additionally linked in key order, so iteration and range scans never climb the tree.
+// KeyType is an integer type or std::string.
+template <typename KeyType, typename ValueType>
+class RadixTreeMap
+{
+public:
+  using key_type = KeyType;
+  using mapped_type = ValueType;
+  using value_type = std::pair<key_type, mapped_type>;
+  using size_type = std::size_t;
+  using reference = value_type &;
+  using const_reference = const value_type &;
+
+  class ConstIterator;
+  class Iterator;
+  using iterator = Iterator;
+  using const_iterator = ConstIterator;
+
+private:
+  static constexpr std::uint32_t maxPrefixLength = 8;
+
+  enum class NodeType : std::uint8_t
+  {
+    node4,
+    node16,
+    node48,
+    node256
+  };
+
+  struct Leaf
+  {
+    value_type value;
+    Leaf *previous = nullptr;
+    Leaf *next = nullptr;
+
+    Leaf(const value_type &value)
+        : value(value) {}
+  };
+
+  // children are Node pointers, leaves are tagged with the lowest bit
+  struct Node
+  {
+    NodeType type;
+    std::uint16_t count = 0; // children, without the terminal leaf
+    std::uint32_t prefixLength = 0;
+    std::uint8_t prefix[maxPrefixLength];
+    Leaf *terminal = nullptr; // the key ending right after the prefix
+
+    explicit Node(NodeType type)
+        : type(type) {}
+  };
+
+  // keys sorted
+  struct Node4 : Node
+  {
+    std::uint8_t keys[4];
+    Node *children[4];
+
+    Node4()
+        : Node(NodeType::node4) {}
+  };
+
+  // keys sorted
+  struct Node16 : Node
+  {
+    std::uint8_t keys[16];
+    Node *children[16];
+
+    Node16()
+        : Node(NodeType::node16) {}
+  };
+
+  // slotOf[byte] is 0 for a missing child, slot + 1 otherwise
+  struct Node48 : Node
+  {
+    std::uint8_t slotOf[256] = {};
+    Node *children[48] = {};
+
+    Node48()
+        : Node(NodeType::node48) {}
+  };
+
+  struct Node256 : Node
+  {
+    Node *children[256] = {};
+
+    Node256()
+        : Node(NodeType::node256) {}
+  };
+
+  Node *root = nullptr;
+  Leaf *first = nullptr;
+  Leaf *last = nullptr;
+  size_type size = 0;
+
+  static bool isLeaf(const Node *n)
+  {
+    return reinterpret_cast<std::uintptr_t>(n) & 1;
+  }
+
+  static Leaf *asLeaf(const Node *n)
+  {
+    return reinterpret_cast<Leaf *>(reinterpret_cast<std::uintptr_t>(n) & ~std::uintptr_t(1));
+  }
+
+  static Node *tagLeaf(Leaf *leaf)
+  {
+    return reinterpret_cast<Node *>(reinterpret_cast<std::uintptr_t>(leaf) | 1);
+  }
+
+  static void deleteNode(Node *n)
+  {
+    switch (n->type)
+    {
+    case NodeType::node4:
+      delete static_cast<Node4 *>(n);
+      break;
+    case NodeType::node16:
+      delete static_cast<Node16 *>(n);
+      break;
+    case NodeType::node48:
+      delete static_cast<Node48 *>(n);
+      break;
+    case NodeType::node256:
+      delete static_cast<Node256 *>(n);
+      break;
+    }
+  }
+
+  static Node **findChild(Node *n, std::uint8_t byte)
+  {
+    switch (n->type)
+    {
+    case NodeType::node4:
+    {
+      auto node = static_cast<Node4 *>(n);
+
+      for (int i = 0; i < node->count; ++i)
+      {
+        if (node->keys[i] == byte)
+        {
+          return &node->children[i];
+        }
+      }
+
+      return nullptr;
+    }
+    case NodeType::node16:
+    {
+      auto node = static_cast<Node16 *>(n);
+#ifdef __SSE2__
+      // compares all 16 keys at once
+      __m128i matches = _mm_cmpeq_epi8(_mm_set1_epi8(static_cast<char>(byte)),
+                                       _mm_loadu_si128(reinterpret_cast<const __m128i *>(node->keys)));
+      unsigned mask = _mm_movemask_epi8(matches) & ((1u << node->count) - 1);
+
+      return mask ? &node->children[__builtin_ctz(mask)] : nullptr;
+#else
+      for (int i = 0; i < node->count; ++i)
+      {
+        if (node->keys[i] == byte)
+        {
+          return &node->children[i];
+        }
+      }
+
+      return nullptr;
+#endif
+    }
+    case NodeType::node48:
+    {
+      auto node = static_cast<Node48 *>(n);
+      return node->slotOf[byte] ? &node->children[node->slotOf[byte] - 1] : nullptr;
+    }
+    case NodeType::node256:
+    {
+      auto node = static_cast<Node256 *>(n);
+      return node->children[byte] ? &node->children[byte] : nullptr;
+    }
+    }
+
+    return nullptr;
+  }
+
+  // first child whose byte is greater than byte (pass -1 for the smallest child)
+  static Node *childAbove(const Node *n, int byte)
+  {
+    switch (n->type)
+    {
+    case NodeType::node4:
+    {
+      auto node = static_cast<const Node4 *>(n);
+      auto it = std::upper_bound(node->keys, node->keys + node->count, byte,
+                                 [](int value, std::uint8_t key) { return value < key; });
+      return it == node->keys + node->count ? nullptr : node->children[it - node->keys];
+    }
+    case NodeType::node16:
+    {
+      auto node = static_cast<const Node16 *>(n);
+      auto it = std::upper_bound(node->keys, node->keys + node->count, byte,
+                                 [](int value, std::uint8_t key) { return value < key; });
+      return it == node->keys + node->count ? nullptr : node->children[it - node->keys];
+    }
+    case NodeType::node48:
+    {
+      auto node = static_cast<const Node48 *>(n);
+
+      for (int i = byte + 1; i < 256; ++i)
+      {
+        if (node->slotOf[i])
+        {
+          return node->children[node->slotOf[i] - 1];
+        }
+      }
+
+      return nullptr;
+    }
+    case NodeType::node256:
+    {
+      auto node = static_cast<const Node256 *>(n);
+
+      for (int i = byte + 1; i < 256; ++i)
+      {
+        if (node->children[i])
+        {
+          return node->children[i];
+        }
+      }
+
+      return nullptr;
+    }
+    }
+
+    return nullptr;
+  }
+
+  static Node *lastChild(const Node *n)
+  {
+    switch (n->type)
+    {
+    case NodeType::node4:
+      return static_cast<const Node4 *>(n)->children[n->count - 1];
+    case NodeType::node16:
+      return static_cast<const Node16 *>(n)->children[n->count - 1];
+    case NodeType::node48:
+    {
+      auto node = static_cast<const Node48 *>(n);
+
+      for (int i = 255; i >= 0; --i)
+      {
+        if (node->slotOf[i])
+        {
+          return node->children[node->slotOf[i] - 1];
+        }
+      }
+
+      return nullptr;
+    }
+    case NodeType::node256:
+    {
+      auto node = static_cast<const Node256 *>(n);
+
+      for (int i = 255; i >= 0; --i)
+      {
+        if (node->children[i])
+        {
+          return node->children[i];
+        }
+      }
+
+      return nullptr;
+    }
+    }
+
+    return nullptr;
+  }
+
+  static Leaf *minimumLeaf(const Node *n)
+  {
+    while (!isLeaf(n))
+    {
+      if (n->terminal)
+      {
+        return n->terminal;
+      }
+
+      n = childAbove(n, -1);
+    }
+
+    return asLeaf(n);
+  }
+
+  static Leaf *maximumLeaf(const Node *n)
+  {
+    while (!isLeaf(n))
+    {
+      n = n->count ? lastChild(n) : tagLeaf(n->terminal);
+    }
+
+    return asLeaf(n);
+  }
+
+  static void copyHeader(Node *to, const Node *from)
+  {
+    to->count = from->count;
+    to->prefixLength = from->prefixLength;
+    to->terminal = from->terminal;
+    std::memcpy(to->prefix, from->prefix, std::min(from->prefixLength, maxPrefixLength));
+  }
+
+  template <typename SortedNode>
+  static void insertSorted(SortedNode *node, std::uint8_t byte, Node *child)
+  {
+    int position = std::upper_bound(node->keys, node->keys + node->count, byte) - node->keys;
+
+    std::memmove(node->keys + position + 1, node->keys + position, node->count - position);
+    std::memmove(node->children + position + 1, node->children + position, (node->count - position) * sizeof(Node *));
+
+    node->keys[position] = byte;
+    node->children[position] = child;
+    ++node->count;
+  }
+
+  // adds child under byte, replacing n (hanging on ref) by a bigger node when it is full
+  static void addChild(Node *&ref, Node *n, std::uint8_t byte, Node *child)
+  {
+    switch (n->type)
+    {
+    case NodeType::node4:
+    {
+      auto node = static_cast<Node4 *>(n);
+
+      if (node->count < 4)
+      {
+        insertSorted(node, byte, child);
+        return;
+      }
+
+      auto bigger = new Node16();
+      copyHeader(bigger, node);
+      std::copy(node->keys, node->keys + 4, bigger->keys);
+      std::copy(node->children, node->children + 4, bigger->children);
+      insertSorted(bigger, byte, child);
+
+      ref = bigger;
+      delete node;
+      return;
+    }
+    case NodeType::node16:
+    {
+      auto node = static_cast<Node16 *>(n);
+
+      if (node->count < 16)
+      {
+        insertSorted(node, byte, child);
+        return;
+      }
+
+      auto bigger = new Node48();
+      copyHeader(bigger, node);
+
+      for (int i = 0; i < 16; ++i)
+      {
+        bigger->children[i] = node->children[i];
+        bigger->slotOf[node->keys[i]] = i + 1;
+      }
+
+      bigger->children[16] = child;
+      bigger->slotOf[byte] = 17;
+      ++bigger->count;
+
+      ref = bigger;
+      delete node;
+      return;
+    }
+    case NodeType::node48:
+    {
+      auto node = static_cast<Node48 *>(n);
+
+      if (node->count < 48)
+      {
+        int slot = 0;
+
+        while (node->children[slot])
+        {
+          ++slot;
+        }
+
+        node->children[slot] = child;
+        node->slotOf[byte] = slot + 1;
+        ++node->count;
+        return;
+      }
+
+      auto bigger = new Node256();
+      copyHeader(bigger, node);
+
+      for (int i = 0; i < 256; ++i)
+      {
+        if (node->slotOf[i])
+        {
+          bigger->children[i] = node->children[node->slotOf[i] - 1];
+        }
+      }
+
+      bigger->children[byte] = child;
+      ++bigger->count;
+
+      ref = bigger;
+      delete node;
+      return;
+    }
+    case NodeType::node256:
+    {
+      auto node = static_cast<Node256 *>(n);
+      node->children[byte] = child;
+      ++node->count;
+      return;
+    }
+    }
+  }
+
+  template <typename SortedNode>
+  static void eraseSorted(SortedNode *node, std::uint8_t byte)
+  {
+    int position = std::find(node->keys, node->keys + node->count, byte) - node->keys;
+
+    std::memmove(node->keys + position, node->keys + position + 1, node->count - position - 1);
+    std::memmove(node->children + position, node->children + position + 1, (node->count - position - 1) * sizeof(Node *));
+    --node->count;
+  }
+
+  // removes the child under byte, replacing n (hanging on ref) by a smaller node when it gets sparse
+  static void removeChild(Node *&ref, Node *n, std::uint8_t byte)
+  {
+    switch (n->type)
+    {
+    case NodeType::node4:
+      eraseSorted(static_cast<Node4 *>(n), byte);
+      collapse(ref, n);
+      return;
+    case NodeType::node16:
+    {
+      auto node = static_cast<Node16 *>(n);
+      eraseSorted(node, byte);
+
+      if (node->count <= 3)
+      {
+        auto smaller = new Node4();
+        copyHeader(smaller, node);
+        std::copy(node->keys, node->keys + node->count, smaller->keys);
+        std::copy(node->children, node->children + node->count, smaller->children);
+
+        ref = smaller;
+        delete node;
+      }
+
+      return;
+    }
+    case NodeType::node48:
+    {
+      auto node = static_cast<Node48 *>(n);
+      node->children[node->slotOf[byte] - 1] = nullptr;
+      node->slotOf[byte] = 0;
+      --node->count;
+
+      if (node->count <= 12)
+      {
+        auto smaller = new Node16();
+        copyHeader(smaller, node);
+        smaller->count = 0;
+
+        for (int i = 0; i < 256; ++i)
+        {
+          if (node->slotOf[i])
+          {
+            smaller->keys[smaller->count] = i;
+            smaller->children[smaller->count++] = node->children[node->slotOf[i] - 1];
+          }
+        }
+
+        ref = smaller;
+        delete node;
+      }
+
+      return;
+    }
+    case NodeType::node256:
+    {
+      auto node = static_cast<Node256 *>(n);
+      node->children[byte] = nullptr;
+      --node->count;
+
+      // shrinks later than a Node48 grows, so alternating inserts and removals do not thrash
+      if (node->count <= 37)
+      {
+        auto smaller = new Node48();
+        copyHeader(smaller, node);
+        smaller->count = 0;
+
+        for (int i = 0; i < 256; ++i)
+        {
+          if (node->children[i])
+          {
+            smaller->children[smaller->count] = node->children[i];
+            smaller->slotOf[i] = ++smaller->count;
+          }
+        }
+
+        ref = smaller;
+        delete node;
+      }
+
+      return;
+    }
+    }
+  }
+
+  // a Node4 left with a single entry is replaced by it, a single child inherits the node's prefix
+  static void collapse(Node *&ref, Node *n)
+  {
+    if (n->type != NodeType::node4 || n->count + (n->terminal != nullptr) != 1)
+    {
+      return;
+    }
+
+    auto node = static_cast<Node4 *>(n);
+
+    if (node->terminal)
+    {
+      ref = tagLeaf(node->terminal);
+    }
+    else if (isLeaf(node->children[0]))
+    {
+      ref = node->children[0];
+    }
+    else
+    {
+      Node *child = node->children[0];
+      std::uint8_t merged[maxPrefixLength];
+      std::uint32_t length = std::min(node->prefixLength, maxPrefixLength);
+
+      std::memcpy(merged, node->prefix, length);
+
+      if (length < maxPrefixLength)
+      {
+        merged[length++] = node->keys[0];
+      }
+
+      std::uint32_t childLength = std::min(std::min(child->prefixLength, maxPrefixLength), maxPrefixLength - length);
+      std::memcpy(merged + length, child->prefix, childLength);
+
+      child->prefixLength += node->prefixLength + 1;
+      std::memcpy(child->prefix, merged, std::min(child->prefixLength, maxPrefixLength));
+      ref = child;
+    }
+
+    delete node;
+  }
+
+  // length of the common part of n's prefix and the key from depth on
+  static std::uint32_t prefixMatch(const Node *n, const RadixKey<key_type> &key, std::size_t depth)
+  {
+    std::uint32_t limit = std::min<std::size_t>(n->prefixLength, key.size() - depth);
+    std::uint32_t i = 0;
+
+    for (; i < std::min(limit, maxPrefixLength); ++i)
+    {
+      if (n->prefix[i] != key[depth + i])
+      {
+        return i;
+      }
+    }
+
+    if (i < limit)
+    {
+      RadixKey<key_type> stored(minimumLeaf(n)->value.first);
+
+      for (; i < limit; ++i)
+      {
+        if (stored[depth + i] != key[depth + i])
+        {
+          return i;
+        }
+      }
+    }
+
+    return limit;
+  }
+
+  // -1 if every key below n is greater than key, 1 if every one is smaller, 0 if key matches n's prefix
+  static int comparePrefix(const Node *n, const RadixKey<key_type> &key, std::size_t depth)
+  {
+    std::uint32_t matched = prefixMatch(n, key, depth);
+
+    if (matched == n->prefixLength)
+    {
+      return 0;
+    }
+
+    if (depth + matched == key.size())
+    {
+      return -1;
+    }
+
+    std::uint8_t stored = matched < maxPrefixLength ? n->prefix[matched]
+                                                    : RadixKey<key_type>(minimumLeaf(n)->value.first)[depth + matched];
+
+    return key[depth + matched] < stored ? -1 : 1;
+  }
+
+  // attaches leaf to a new node whose entries branch at position depth of the keys
+  static void placeLeaf(Node4 *node, Leaf *leaf, const RadixKey<key_type> &key, std::size_t depth)
+  {
+    if (key.size() == depth)
+    {
+      node->terminal = leaf;
+    }
+    else
+    {
+      insertSorted(node, key[depth], tagLeaf(leaf));
+    }
+  }
+
+  static void setPrefix(Node *n, const std::uint8_t *bytes, std::size_t length)
+  {
+    n->prefixLength = length;
+    std::memcpy(n->prefix, bytes, std::min<std::size_t>(length, maxPrefixLength));
+  }
+
+  Leaf *findLeaf(const key_type &key) const
+  {
+    RadixKey<key_type> bytes(key);
+    const Node *n = root;
+    std::size_t depth = 0;
+
+    while (n && !isLeaf(n))
+    {
+      if (n->prefixLength)
+      {
+        // optimistic: bytes beyond the stored part of the prefix are checked at the leaf
+        if (depth + n->prefixLength > bytes.size() ||
+            std::memcmp(n->prefix, bytes.data() + depth, std::min(n->prefixLength, maxPrefixLength)) != 0)
+        {
+          return nullptr;
+        }
+
+        depth += n->prefixLength;
+      }
+
+      if (depth == bytes.size())
+      {
+        return (n->terminal && n->terminal->value.first == key) ? n->terminal : nullptr;
+      }
+
+      Node **child = findChild(const_cast<Node *>(n), bytes[depth]);
+
+      if (child == nullptr)
+      {
+        return nullptr;
+      }
+
+      n = *child;
+      ++depth;
+    }
+
+    return (n && asLeaf(n)->value.first == key) ? asLeaf(n) : nullptr;
+  }
+
+  // first leaf whose key is not smaller than key, nullptr if there is none
+  Leaf *lowerBoundLeaf(const key_type &key) const
+  {
+    RadixKey<key_type> bytes(key);
+    const Node *n = root;
+    std::size_t depth = 0;
+
+    while (n)
+    {
+      if (isLeaf(n))
+      {
+        Leaf *leaf = asLeaf(n);
+        return leaf->value.first < key ? leaf->next : leaf;
+      }
+
+      int direction = comparePrefix(n, bytes, depth);
+
+      if (direction < 0)
+      {
+        return minimumLeaf(n);
+      }
+
+      if (direction > 0)
+      {
+        return maximumLeaf(n)->next;
+      }
+
+      depth += n->prefixLength;
+
+      if (depth == bytes.size())
+      {
+        return minimumLeaf(n);
+      }
+
+      if (Node **child = findChild(const_cast<Node *>(n), bytes[depth]))
+      {
+        n = *child;
+        ++depth;
+        continue;
+      }
+
+      const Node *above = childAbove(n, bytes[depth]);
+      return above ? minimumLeaf(above) : maximumLeaf(n)->next;
+    }
+
+    return nullptr;
+  }
+
+  void link(Leaf *leaf, Leaf *next)
+  {
+    leaf->next = next;
+    leaf->previous = next ? next->previous : last;
+
+    (leaf->previous ? leaf->previous->next : first) = leaf;
+    (next ? next->previous : last) = leaf;
+  }
+
+  void unlink(Leaf *leaf)
+  {
+    (leaf->previous ? leaf->previous->next : first) = leaf->next;
+    (leaf->next ? leaf->next->previous : last) = leaf->previous;
+  }
+
+  // key must be missing, next is the leaf following it
+  Leaf *insert(const key_type &key, const mapped_type &value, Leaf *next)
+  {
+    Leaf *leaf = new Leaf({key, value});
+    link(leaf, next);
+    ++size;
+
+    RadixKey<key_type> bytes(leaf->value.first);
+    Node **ref = &root;
+    std::size_t depth = 0;
+
+    while (true)
+    {
+      Node *n = *ref;
+
+      if (n == nullptr)
+      {
+        *ref = tagLeaf(leaf);
+        return leaf;
+      }
+
+      if (isLeaf(n))
+      {
+        // lazy expansion: a new node branches where the two keys differ
+        Leaf *other = asLeaf(n);
+        RadixKey<key_type> otherBytes(other->value.first);
+        std::size_t common = depth;
+
+        while (common < bytes.size() && common < otherBytes.size() && bytes[common] == otherBytes[common])
+        {
+          ++common;
+        }
+
+        auto split = new Node4();
+        setPrefix(split, bytes.data() + depth, common - depth);
+        placeLeaf(split, other, otherBytes, common);
+        placeLeaf(split, leaf, bytes, common);
+
+        *ref = split;
+        return leaf;
+      }
+
+      if (n->prefixLength)
+      {
+        std::uint32_t matched = prefixMatch(n, bytes, depth);
+
+        if (matched < n->prefixLength)
+        {
+          // the key leaves the prefix, a new node branches there and n keeps the rest of its prefix
+          auto split = new Node4();
+          setPrefix(split, bytes.data() + depth, matched);
+
+          std::uint8_t branch;
+          std::uint32_t restLength = n->prefixLength - matched - 1;
+
+          if (n->prefixLength <= maxPrefixLength)
+          {
+            branch = n->prefix[matched];
+            std::memmove(n->prefix, n->prefix + matched + 1, restLength);
+          }
+          else
+          {
+            RadixKey<key_type> stored(minimumLeaf(n)->value.first);
+            branch = stored[depth + matched];
+            std::memcpy(n->prefix, stored.data() + depth + matched + 1, std::min(restLength, maxPrefixLength));
+          }
+
+          n->prefixLength = restLength;
+          insertSorted(split, branch, n);
+          placeLeaf(split, leaf, bytes, depth + matched);
+
+          *ref = split;
+          return leaf;
+        }
+
+        depth += n->prefixLength;
+      }
+
+      if (depth == bytes.size())
+      {
+        n->terminal = leaf;
+        return leaf;
+      }
+
+      Node **child = findChild(n, bytes[depth]);
+
+      if (child == nullptr)
+      {
+        addChild(*ref, n, bytes[depth], tagLeaf(leaf));
+        return leaf;
+      }
+
+      ref = child;
+      ++depth;
+    }
+  }
+
+  void erase(Leaf *leaf)
+  {
+    unlink(leaf);
+    delete leaf;
+    --size;
+  }
+
+  // returns false if key is missing
+  bool removeKey(const key_type &key)
+  {
+    if (root && isLeaf(root))
+    {
+      if (!(asLeaf(root)->value.first == key))
+      {
+        return false;
+      }
+
+      erase(asLeaf(root));
+      root = nullptr;
+      return true;
+    }
+
+    RadixKey<key_type> bytes(key);
+    Node **ref = &root;
+    std::size_t depth = 0;
+
+    while (*ref)
+    {
+      Node *n = *ref;
+
+      if (n->prefixLength)
+      {
+        if (depth + n->prefixLength > bytes.size() ||
+            std::memcmp(n->prefix, bytes.data() + depth, std::min(n->prefixLength, maxPrefixLength)) != 0)
+        {
+          return false;
+        }
+
+        depth += n->prefixLength;
+      }
+
+      if (depth == bytes.size())
+      {
+        Leaf *leaf = n->terminal;
+
+        if (leaf == nullptr || !(leaf->value.first == key))
+        {
+          return false;
+        }
+
+        n->terminal = nullptr;
+        collapse(*ref, n);
+        erase(leaf);
+        return true;
+      }
+
+      Node **child = findChild(n, bytes[depth]);
+
+      if (child == nullptr)
+      {
+        return false;
+      }
+
+      if (isLeaf(*child))
+      {
+        Leaf *leaf = asLeaf(*child);
+
+        if (!(leaf->value.first == key))
+        {
+          return false;
+        }
+
+        removeChild(*ref, n, bytes[depth]);
+        erase(leaf);
+        return true;
+      }
+
+      ref = child;
+      ++depth;
+    }
+
+    return false;
+  }
+
+  static void removeTree(Node *n)
+  {
+    if (n == nullptr)
+    {
+      return;
+    }
+
+    if (isLeaf(n))
+    {
+      delete asLeaf(n);
+      return;
+    }
+
+    if (n->terminal)
+    {
+      delete n->terminal;
+    }
+
+    forEachChild(n, [](Node *&child) { removeTree(child); });
+    deleteNode(n);
+  }
+
+  // copies the subtree, appending its leaves to the list ending at last
+  Node *copyTree(const Node *n)
+  {
+    if (isLeaf(n))
+    {
+      Leaf *leaf = new Leaf(asLeaf(n)->value);
+      link(leaf, nullptr);
+      return tagLeaf(leaf);
+    }
+
+    Node *copy = nullptr;
+
+    switch (n->type)
+    {
+    case NodeType::node4:
+      copy = new Node4(*static_cast<const Node4 *>(n));
+      break;
+    case NodeType::node16:
+      copy = new Node16(*static_cast<const Node16 *>(n));
+      break;
+    case NodeType::node48:
+      copy = new Node48(*static_cast<const Node48 *>(n));
+      break;
+    case NodeType::node256:
+      copy = new Node256(*static_cast<const Node256 *>(n));
+      break;
+    }
+
+    if (n->terminal)
+    {
+      copy->terminal = new Leaf(n->terminal->value);
+      link(copy->terminal, nullptr);
+    }
+
+    forEachChild(copy, [this](Node *&child) { child = copyTree(child); });
+
+    return copy;
+  }
+
+  // calls function(childSlot) for the children of n in byte order
+  template <typename Function>
+  static void forEachChild(Node *n, Function function)
+  {
+    switch (n->type)
+    {
+    case NodeType::node4:
+    {
+      auto node = static_cast<Node4 *>(n);
+      std::for_each(node->children, node->children + node->count, function);
+      break;
+    }
+    case NodeType::node16:
+    {
+      auto node = static_cast<Node16 *>(n);
+      std::for_each(node->children, node->children + node->count, function);
+      break;
+    }
+    case NodeType::node48:
+    {
+      auto node = static_cast<Node48 *>(n);
+
+      for (int i = 0; i < 256; ++i)
+      {
+        if (node->slotOf[i])
+        {
+          function(node->children[node->slotOf[i] - 1]);
+        }
+      }
+
+      break;
+    }
+    case NodeType::node256:
+    {
+      auto node = static_cast<Node256 *>(n);
+
+      for (int i = 0; i < 256; ++i)
+      {
+        if (node->children[i])
+        {
+          function(node->children[i]);
+        }
+      }
+
+      break;
+    }
+    }
+  }
+
+public:
+  RadixTreeMap() = default;
+
+  RadixTreeMap(std::initializer_list<value_type> list)
+  {
+    for (const auto &[key, value] : list)
+    {
+      (*this)[key] = value;
+    }
+  }
+
+  RadixTreeMap(const RadixTreeMap &other)
+      : size(other.size)
+  {
+    if (other.root)
+    {
+      root = copyTree(other.root);
+    }
+  }
+
+  RadixTreeMap(RadixTreeMap &&other)
+      : root(std::exchange(other.root, nullptr)), first(std::exchange(other.first, nullptr)),
+        last(std::exchange(other.last, nullptr)), size(std::exchange(other.size, 0)) {}
+
+  ~RadixTreeMap()
+  {
+    clear();
+  }
+
+  RadixTreeMap &operator=(const RadixTreeMap &other)
+  {
+    if (this != &other)
+    {
+      *this = RadixTreeMap(other);
+    }
+
+    return *this;
+  }
+
+  RadixTreeMap &operator=(RadixTreeMap &&other)
+  {
+    if (this != &other)
+    {
+      clear();
+      root = std::exchange(other.root, nullptr);
+      first = std::exchange(other.first, nullptr);
+      last = std::exchange(other.last, nullptr);
+      size = std::exchange(other.size, 0);
+    }
+
+    return *this;
+  }
+
+  bool isEmpty() const
+  {
+    return size == 0;
+  }
+
+  size_type getSize() const
+  {
+    return size;
+  }
+
+  mapped_type &operator[](const key_type &key)
+  {
+    Leaf *next = lowerBoundLeaf(key);
+
+    if (next && next->value.first == key)
+    {
+      return next->value.second;
+    }
+
+    return insert(key, mapped_type(), next)->value.second;
+  }
+
+  // Inserts key or replaces its value, returns true if the key was not present.
+  bool upsert(const key_type &key, const mapped_type &value)
+  {
+    Leaf *next = lowerBoundLeaf(key);
+
+    if (next && next->value.first == key)
+    {
+      next->value.second = value;
+      return false;
+    }
+
+    insert(key, value, next);
+    return true;
+  }
+
+  const mapped_type &valueOf(const key_type &key) const
+  {
+    Leaf *leaf = findLeaf(key);
+
+    if (leaf == nullptr)
+    {
+      throw std::out_of_range("Value not found!");
+    }
+
+    return leaf->value.second;
+  }
+
+  mapped_type &valueOf(const key_type &key)
+  {
+    Leaf *leaf = findLeaf(key);
+
+    if (leaf == nullptr)
+    {
+      throw std::out_of_range("Value not found!");
+    }
+
+    return leaf->value.second;
+  }
+
+  const_iterator find(const key_type &key) const
+  {
+    return const_iterator(this, findLeaf(key));
+  }
+
+  iterator find(const key_type &key)
+  {
+    return iterator(const_iterator(this, findLeaf(key)));
+  }
+
+  // First item whose key is not smaller than key.
+  const_iterator lowerBound(const key_type &key) const
+  {
+    return const_iterator(this, lowerBoundLeaf(key));
+  }
+
+  iterator lowerBound(const key_type &key)
+  {
+    return iterator(const_iterator(this, lowerBoundLeaf(key)));
+  }
+
+  // Calls function(key, value) in key order for keys in [from, to).
+  template <typename Function>
+  void forEachInRange(const key_type &from, const key_type &to, Function function) const
+  {
+    for (Leaf *leaf = lowerBoundLeaf(from); leaf && leaf->value.first < to; leaf = leaf->next)
+    {
+      function(leaf->value.first, leaf->value.second);
+    }
+  }
+
+  // Calls function(key, value) in key order for keys starting with the bytes of prefix.
+  template <typename Function>
+  void forEachWithPrefix(const key_type &prefix, Function function) const
+  {
+    RadixKey<key_type> prefixBytes(prefix);
+
+    for (Leaf *leaf = lowerBoundLeaf(prefix); leaf; leaf = leaf->next)
+    {
+      RadixKey<key_type> bytes(leaf->value.first);
+
+      if (bytes.size() < prefixBytes.size() || std::memcmp(bytes.data(), prefixBytes.data(), prefixBytes.size()) != 0)
+      {
+        return;
+      }
+
+      function(leaf->value.first, leaf->value.second);
+    }
+  }
+
+  void remove(const key_type &key)
+  {
+    if (!removeKey(key))
+    {
+      throw std::out_of_range("Removing non-existing element!");
+    }
+  }
+
+  void remove(const const_iterator &it)
+  {
+    remove(it->first);
+  }
+
+  void clear()
+  {
+    removeTree(root);
+    root = nullptr;
+    first = last = nullptr;
+    size = 0;
+  }
+
+  bool operator==(const RadixTreeMap &other) const
+  {
+    if (size != other.size)
+    {
+      return false;
+    }
+
+    for (Leaf *a = first, *b = other.first; a; a = a->next, b = b->next)
+    {
+      if (a->value != b->value)
+      {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  bool operator!=(const RadixTreeMap &other) const
+  {
+    return !(*this == other);
+  }
+
+  iterator begin()
+  {
+    return iterator(cbegin());
+  }
+
+  iterator end()
+  {
+    return iterator(cend());
+  }
+
+  const_iterator cbegin() const
+  {
+    return const_iterator(this, first);
+  }
+
+  const_iterator cend() const
+  {
+    return const_iterator(this, nullptr);
+  }
+
+  const_iterator begin() const
+  {
+    return cbegin();
+  }
+
+  const_iterator end() const
+  {
+    return cend();
+  }
+};
+
+template <typename KeyType, typename ValueType>
+class RadixTreeMap<KeyType, ValueType>::ConstIterator
+{
+public:
+  using reference = typename RadixTreeMap::const_reference;
+  using iterator_category = std::bidirectional_iterator_tag;
+  using value_type = typename RadixTreeMap::value_type;
+  using difference_type = std::ptrdiff_t;
+  using pointer = const typename RadixTreeMap::value_type *;
+  using key_type = typename RadixTreeMap::key_type;
+  using mapped_type = typename RadixTreeMap::mapped_type;
+
+private:
+  const RadixTreeMap *map = nullptr;
+  Leaf *leaf = nullptr; // nullptr for end()
+
+public:
+  ConstIterator() = default;
+
+  explicit ConstIterator(const RadixTreeMap *map, Leaf *leaf)
+      : map(map), leaf(leaf) {}
+
+  ConstIterator &operator++()
+  {
+    if (leaf == nullptr)
+    {
+      throw std::out_of_range("Incrementing end()");
+    }
+
+    leaf = leaf->next;
+
+    return *this;
+  }
+
+  ConstIterator operator++(int)
+  {
+    auto tmp = *this;
+    operator++();
+    return tmp;
+  }
+
+  ConstIterator &operator--()
+  {
+    if (map->isEmpty())
+    {
+      throw std::out_of_range("Decrementing iterator of an empty tree!");
+    }
+
+    if (leaf == nullptr)
+    {
+      leaf = map->last;
+      return *this;
+    }
+
+    if (leaf->previous == nullptr)
+    {
+      throw std::out_of_range("Decrementing begin()!");
+    }
+
+    leaf = leaf->previous;
+
+    return *this;
+  }
+
+  ConstIterator operator--(int)
+  {
+    auto tmp = *this;
+    operator--();
+    return tmp;
+  }
+
+  reference operator*() const
+  {
+    if (leaf == nullptr)
+    {
+      throw std::out_of_range("Dereferencing end()!");
+    }
+
+    return leaf->value;
+  }
+
+  pointer operator->() const
+  {
+    return &this->operator*();
+  }
+
+  bool operator==(const ConstIterator &other) const
+  {
+    return map == other.map && leaf == other.leaf;
+  }
+
+  bool operator!=(const ConstIterator &other) const
+  {
+    return !(*this == other);
+  }
+};
+
+template <typename KeyType, typename ValueType>
+class RadixTreeMap<KeyType, ValueType>::Iterator : public RadixTreeMap<KeyType, ValueType>::ConstIterator
+{
+public:
+  using reference = typename RadixTreeMap::reference;
+  using pointer = typename RadixTreeMap::value_type *;
+
+  Iterator() = default;
+
+  Iterator(const ConstIterator &other)
+      : ConstIterator(other)
+  {
+  }
+
+  Iterator &operator++()
+  {
+    ConstIterator::operator++();
+    return *this;
+  }
+
+  Iterator operator++(int)
+  {
+    auto result = *this;
+    ConstIterator::operator++();
+    return result;
+  }
+
+  Iterator &operator--()
+  {
+    ConstIterator::operator--();
+    return *this;
+  }
+
+  Iterator operator--(int)
+  {
+    auto result = *this;
+    ConstIterator::operator--();
+    return result;
+  }
+
+  pointer operator->() const
+  {
+    return &this->operator*();
+  }
+
+  reference operator*() const
+  {
+    return const_cast<reference>(ConstIterator::operator*());
+  }
+};
+
+} // namespace aisdi
+
+#endif /* AISDI_MAPS_RADIXTREEMAP_H */
@@ -0,0 +1,89 @@
+#ifndef AISDI_MAPS_SNAPSHOTTREEMAP_H
+#define AISDI_MAPS_SNAPSHOTTREEMAP_H
+
+#include <cstddef>
+#include <initializer_list>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+#include "PersistentTreeMap.h"
+
+namespace aisdi
+{
+
+// Mutable map for one or more writers and any number of concurrent readers.
+// Every write builds a new PersistentTreeMap version by copying only the nodes on the modified path
+// and publishes it atomically; snapshot() grabs the current version in O(1).
+// Readers never take the writers' lock and a snapshot never blocks later writes.
+template <typename KeyType, typename ValueType>
+class SnapshotTreeMap
+{
+public:
+  using key_type = KeyType;
+  using mapped_type = ValueType;
+  using snapshot_type = PersistentTreeMap<KeyType, ValueType>;
+  using value_type = typename snapshot_type::value_type;
+  using size_type = std::size_t;
+
+private:
+  std::shared_ptr<const snapshot_type> current = std::make_shared<const snapshot_type>();
+  std::mutex writeMutex;
+
+  void publish(snapshot_type &&version)
+  {
+    std::atomic_store(&current, std::make_shared<const snapshot_type>(std::move(version)));
+  }
+
+  std::shared_ptr<const snapshot_type> load() const
+  {
+    return std::atomic_load(&current);
+  }
+
+public:
+  SnapshotTreeMap() = default;
+
+  SnapshotTreeMap(std::initializer_list<value_type> list)
+      : current(std::make_shared<const snapshot_type>(list)) {}
+
+  SnapshotTreeMap(const SnapshotTreeMap &) = delete;
+  SnapshotTreeMap &operator=(const SnapshotTreeMap &) = delete;
+
+  // Read-only view of the map as of now, unaffected by later writes.
+  snapshot_type snapshot() const
+  {
+    return *load();
+  }
+
+  void insert(const key_type &key, const mapped_type &value)
+  {
+    std::lock_guard<std::mutex> lock(writeMutex);
+    publish(load()->insert(key, value));
+  }
+
+  void remove(const key_type &key)
+  {
+    std::lock_guard<std::mutex> lock(writeMutex);
+    publish(load()->remove(key));
+  }
+
+  // Returns a copy, as the version holding the value may be reclaimed after the next write.
+  mapped_type valueOf(const key_type &key) const
+  {
+    return load()->valueOf(key);
+  }
+
+  bool isEmpty() const
+  {
+    return load()->isEmpty();
+  }
+
+  size_type getSize() const
+  {
+    return load()->getSize();
+  }
+};
+
+} // namespace aisdi
+
+#endif /* AISDI_MAPS_SNAPSHOTTREEMAP_H */
@@ -0,0 +1,283 @@
+#ifndef AISDI_MAPS_TASKPOOL_H
+#define AISDI_MAPS_TASKPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace aisdi
+{
+
+// Work-stealing pool for fork-join parallelism.
+// The thread calling invoke() takes part in the computation, so a pool of n threads starts n - 1 workers.
+class TaskPool
+{
+private:
+  struct Task
+  {
+    void (*run)(void *);
+    void *function;
+    std::atomic<bool> done{false};
+    std::exception_ptr error;
+  };
+
+  struct WorkQueue
+  {
+    std::mutex mutex;
+    std::deque<Task *> tasks;
+  };
+
+  std::vector<std::unique_ptr<WorkQueue>> queues;
+  std::vector<std::thread> workers;
+
+  std::atomic<std::size_t> queuedTasks{0};
+  std::atomic<bool> stopping{false};
+  std::mutex sleepMutex;
+  std::condition_variable wakeUp;
+
+  static thread_local const TaskPool *currentPool;
+  static thread_local std::size_t currentQueue;
+
+  std::size_t myQueue() const
+  {
+    return currentPool == this ? currentQueue : 0;
+  }
+
+  void push(std::size_t index, Task *task)
+  {
+    {
+      std::lock_guard<std::mutex> lock(queues[index]->mutex);
+      queues[index]->tasks.push_back(task);
+    }
+
+    ++queuedTasks;
+
+    {
+      std::lock_guard<std::mutex> lock(sleepMutex);
+    }
+
+    wakeUp.notify_one();
+  }
+
+  // takes back a task pushed by this thread, fails if it was stolen in the meantime
+  bool popIfLast(std::size_t index, Task *task)
+  {
+    std::lock_guard<std::mutex> lock(queues[index]->mutex);
+    auto &tasks = queues[index]->tasks;
+
+    if (!tasks.empty() && tasks.back() == task)
+    {
+      tasks.pop_back();
+      --queuedTasks;
+      return true;
+    }
+
+    return false;
+  }
+
+  Task *popBack(std::size_t index)
+  {
+    std::lock_guard<std::mutex> lock(queues[index]->mutex);
+    auto &tasks = queues[index]->tasks;
+
+    if (tasks.empty())
+    {
+      return nullptr;
+    }
+
+    Task *task = tasks.back();
+    tasks.pop_back();
+    --queuedTasks;
+
+    return task;
+  }
+
+  Task *stealFront(std::size_t index)
+  {
+    std::unique_lock<std::mutex> lock(queues[index]->mutex, std::try_to_lock);
+    auto &tasks = queues[index]->tasks;
+
+    if (!lock.owns_lock() || tasks.empty())
+    {
+      return nullptr;
+    }
+
+    Task *task = tasks.front();
+    tasks.pop_front();
+    --queuedTasks;
+
+    return task;
+  }
+
+  Task *findTask(std::size_t index)
+  {
+    if (Task *task = popBack(index))
+    {
+      return task;
+    }
+
+    for (std::size_t i = 1; i < queues.size(); ++i)
+    {
+      if (Task *task = stealFront((index + i) % queues.size()))
+      {
+        return task;
+      }
+    }
+
+    return nullptr;
+  }
+
+  static void execute(Task *task)
+  {
+    try
+    {
+      task->run(task->function);
+    }
+    catch (...)
+    {
+      task->error = std::current_exception();
+    }
+
+    task->done.store(true, std::memory_order_release);
+  }
+
+  void workerLoop(std::size_t index)
+  {
+    currentPool = this;
+    currentQueue = index;
+
+    while (!stopping.load())
+    {
+      if (Task *task = findTask(index))
+      {
+        execute(task);
+        continue;
+      }
+
+      std::unique_lock<std::mutex> lock(sleepMutex);
+      wakeUp.wait(lock, [this] { return stopping.load() || queuedTasks.load() > 0; });
+    }
+  }
+
+  // runs other tasks until the forked one has finished
+  void join(std::size_t index, Task *task)
+  {
+    if (popIfLast(index, task))
+    {
+      execute(task);
+      return;
+    }
+
+    while (!task->done.load(std::memory_order_acquire))
+    {
+      if (Task *other = findTask(index))
+      {
+        execute(other);
+      }
+      else
+      {
+        std::this_thread::yield();
+      }
+    }
+  }
+
+public:
+  explicit TaskPool(unsigned threads = std::thread::hardware_concurrency())
+  {
+    if (threads == 0)
+    {
+      threads = 1;
+    }
+
+    for (unsigned i = 0; i < threads; ++i)
+    {
+      queues.push_back(std::make_unique<WorkQueue>());
+    }
+
+    for (unsigned i = 1; i < threads; ++i)
+    {
+      workers.emplace_back(&TaskPool::workerLoop, this, i);
+    }
+  }
+
+  TaskPool(const TaskPool &) = delete;
+  TaskPool &operator=(const TaskPool &) = delete;
+
+  ~TaskPool()
+  {
+    {
+      std::lock_guard<std::mutex> lock(sleepMutex);
+      stopping = true;
+    }
+
+    wakeUp.notify_all();
+
+    for (auto &worker : workers)
+    {
+      worker.join();
+    }
+  }
+
+  std::size_t getThreadCount() const
+  {
+    return queues.size();
+  }
+
+  // Runs both functions, possibly in parallel, and returns when both have finished.
+  // An exception thrown by either of them is rethrown here.
+  template <typename First, typename Second>
+  void invoke(First &&first, Second &&second)
+  {
+    if (queues.size() == 1)
+    {
+      first();
+      second();
+      return;
+    }
+
+    Task task;
+    task.run = [](void *function) { (*static_cast<std::remove_reference_t<Second> *>(function))(); };
+    task.function = const_cast<void *>(static_cast<const void *>(std::addressof(second)));
+
+    std::size_t index = myQueue();
+    push(index, &task);
+
+    std::exception_ptr error;
+
+    try
+    {
+      first();
+    }
+    catch (...)
+    {
+      error = std::current_exception();
+    }
+
+    join(index, &task);
+
+    if (error)
+    {
+      std::rethrow_exception(error);
+    }
+
+    if (task.error)
+    {
+      std::rethrow_exception(task.error);
+    }
+  }
+};
+
+inline thread_local const TaskPool *TaskPool::currentPool = nullptr;
+inline thread_local std::size_t TaskPool::currentQueue = 0;
+
+} // namespace aisdi
+
+#endif /* AISDI_MAPS_TASKPOOL_H */
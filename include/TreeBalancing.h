@@ -0,0 +1,358 @@
+#ifndef AISDI_MAPS_TREEBALANCING_H
+#define AISDI_MAPS_TREEBALANCING_H
+
+#include <algorithm>
+
+namespace aisdi
+{
+
+// Balancing policies for TreeMap. Every node keeps an integer rank, a missing child has rank 0
+// and a new leaf rank 1; a policy decides which rank differences between a node and its children
+// are allowed and restores them after an update by promoting, demoting and rotating nodes.
+// TreeMap calls
+//   builtRank(l, r)               rank of a node built over median-split subtrees of ranks l and r,
+//   afterInsert(tree, n)          after attaching the new leaf n,
+//   afterRemove(tree, p, left)    after the left (or right) subtree of p lost a node,
+//   hasValidRanks(n)              whether the rank rules hold between n and its children, for tests,
+// and a policy restructures the tree only through tree.rotateUp(n), which rotates n above its parent.
+struct RankBalancing
+{
+  template <typename Node>
+  static int rank(const Node *n)
+  {
+    return n ? n->rank : 0;
+  }
+};
+
+// Rank is the height and the children of a node differ in height by at most one.
+// Gives the shallowest trees, but a removal may rotate on every level up to the root.
+struct AvlBalancing : RankBalancing
+{
+  static int builtRank(int left, int right)
+  {
+    return std::max(left, right) + 1;
+  }
+
+  template <typename Node>
+  static bool hasValidRanks(const Node *n)
+  {
+    return n->rank == std::max(rank(n->lChild), rank(n->rChild)) + 1 && !isUnbalanced(n);
+  }
+
+  template <typename Tree, typename Node>
+  static void afterInsert(Tree &tree, Node *n)
+  {
+    // after an insertion a single (double) rotation restores the subtree's previous height
+    for (n = n->parent; n; n = n->parent)
+    {
+      int oldRank = n->rank;
+      update(n);
+
+      if (isUnbalanced(n))
+      {
+        rebalance(tree, n);
+        return;
+      }
+
+      if (n->rank == oldRank)
+      {
+        return;
+      }
+    }
+  }
+
+  template <typename Tree, typename Node>
+  static void afterRemove(Tree &tree, Node *n, bool)
+  {
+    while (n)
+    {
+      int oldRank = n->rank;
+      update(n);
+
+      if (isUnbalanced(n))
+      {
+        n = rebalance(tree, n);
+      }
+
+      if (n->rank == oldRank)
+      {
+        return;
+      }
+
+      n = n->parent;
+    }
+  }
+
+private:
+  template <typename Node>
+  static void update(Node *n)
+  {
+    n->rank = std::max(rank(n->lChild), rank(n->rChild)) + 1;
+  }
+
+  template <typename Node>
+  static bool isUnbalanced(const Node *n)
+  {
+    int balance = rank(n->lChild) - rank(n->rChild);
+    return balance > 1 || balance < -1;
+  }
+
+  // rotates the subtree rooted at n whose children differ in height by two, returns its new root
+  template <typename Tree, typename Node>
+  static Node *rebalance(Tree &tree, Node *n)
+  {
+    bool leftIsTaller = rank(n->lChild) > rank(n->rChild);
+    Node *taller = leftIsTaller ? n->lChild : n->rChild;
+    Node *inner = leftIsTaller ? taller->rChild : taller->lChild;
+    Node *outer = leftIsTaller ? taller->lChild : taller->rChild;
+
+    if (rank(inner) > rank(outer))
+    {
+      tree.rotateUp(inner);
+      tree.rotateUp(inner);
+      update(n);
+      update(taller);
+      update(inner);
+
+      return inner;
+    }
+
+    tree.rotateUp(taller);
+    update(n);
+    update(taller);
+
+    return taller;
+  }
+};
+
+// Weak AVL (Haeupler, Sen, Tarjan): rank differences are 1 or 2 and leaves have rank 1.
+// Insertions rebalance exactly like AVL, so a tree built only by insertions is an AVL tree;
+// a removal does at most two rotations and O(1) amortised promotions and demotions.
+struct WavlBalancing : RankBalancing
+{
+  static int builtRank(int left, int right)
+  {
+    return std::max(left, right) + 1;
+  }
+
+  template <typename Node>
+  static bool hasValidRanks(const Node *n)
+  {
+    int left = n->rank - rank(n->lChild);
+    int right = n->rank - rank(n->rChild);
+    bool isLeaf = !n->lChild && !n->rChild;
+
+    return (left == 1 || left == 2) && (right == 1 || right == 2) && (!isLeaf || n->rank == 1);
+  }
+
+  template <typename Tree, typename Node>
+  static void afterInsert(Tree &tree, Node *x)
+  {
+    // x is a 0-child, i.e. has the rank of its parent
+    for (Node *p = x->parent; p && p->rank == x->rank; x = p, p = p->parent)
+    {
+      Node *sibling = (p->lChild == x) ? p->rChild : p->lChild;
+
+      if (p->rank - rank(sibling) == 1)
+      {
+        ++p->rank;
+        continue;
+      }
+
+      Node *inner = (p->lChild == x) ? x->rChild : x->lChild;
+
+      if (x->rank - rank(inner) == 2)
+      {
+        tree.rotateUp(x);
+        --p->rank;
+      }
+      else
+      {
+        tree.rotateUp(inner);
+        tree.rotateUp(inner);
+        ++inner->rank;
+        --x->rank;
+        --p->rank;
+      }
+
+      return;
+    }
+  }
+
+  template <typename Tree, typename Node>
+  static void afterRemove(Tree &tree, Node *p, bool left)
+  {
+    Node *x = left ? p->lChild : p->rChild;
+
+    // p lost its only child and is now a leaf of rank 2
+    if (p->rank == 2 && p->lChild == nullptr && p->rChild == nullptr)
+    {
+      p->rank = 1;
+      x = p;
+      p = p->parent;
+      left = p && p->lChild == x;
+    }
+
+    // x is a 3-child
+    while (p && p->rank - rank(x) == 3)
+    {
+      Node *y = left ? p->rChild : p->lChild;
+
+      if (p->rank - y->rank == 1)
+      {
+        Node *inner = left ? y->lChild : y->rChild;
+        Node *outer = left ? y->rChild : y->lChild;
+
+        if (y->rank - rank(outer) == 1)
+        {
+          tree.rotateUp(y);
+          ++y->rank;
+          --p->rank;
+
+          if (p->lChild == nullptr && p->rChild == nullptr)
+          {
+            --p->rank;
+          }
+
+          return;
+        }
+
+        if (y->rank - rank(inner) == 1)
+        {
+          tree.rotateUp(inner);
+          tree.rotateUp(inner);
+          inner->rank += 2;
+          --y->rank;
+          p->rank -= 2;
+
+          return;
+        }
+
+        --y->rank;
+      }
+
+      --p->rank;
+      x = p;
+      p = p->parent;
+      left = p && p->lChild == x;
+    }
+  }
+};
+
+// Red-black tree in rank form: a node is red when it has the rank of its parent (is a 0-child),
+// the rank is the black height, rank differences are 0 or 1 and no 0-child has a 0-child.
+// Trees are up to twice as deep as AVL ones, in exchange every update does at most three rotations
+// and O(1) amortised rank changes.
+struct RedBlackBalancing : RankBalancing
+{
+  static int builtRank(int left, int right)
+  {
+    // the root of a subtree one level deeper than its sibling becomes red
+    return std::min(left, right) + 1;
+  }
+
+  template <typename Node>
+  static bool hasValidRanks(const Node *n)
+  {
+    const Node *children[] = {n->lChild, n->rChild};
+
+    for (const Node *child : children)
+    {
+      int difference = n->rank - rank(child);
+
+      if (difference != 0 && difference != 1)
+      {
+        return false;
+      }
+
+      if (difference == 0 && child && (rank(child->lChild) == child->rank || rank(child->rChild) == child->rank))
+      {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  template <typename Tree, typename Node>
+  static void afterInsert(Tree &tree, Node *x)
+  {
+    while (true)
+    {
+      Node *p = x->parent;
+
+      if (p == nullptr || p->rank != x->rank || p->parent == nullptr || p->parent->rank != p->rank)
+      {
+        return;
+      }
+
+      // x and p are both red
+      Node *g = p->parent;
+      Node *uncle = (g->lChild == p) ? g->rChild : g->lChild;
+
+      if (rank(uncle) == g->rank)
+      {
+        ++g->rank;
+        x = g;
+        continue;
+      }
+
+      if ((p->lChild == x) != (g->lChild == p))
+      {
+        tree.rotateUp(x);
+        tree.rotateUp(x);
+      }
+      else
+      {
+        tree.rotateUp(p);
+      }
+
+      return;
+    }
+  }
+
+  template <typename Tree, typename Node>
+  static void afterRemove(Tree &tree, Node *p, bool left)
+  {
+    // while the child of p on the given side is a 2-child, i.e. one black node short
+    while (p && p->rank - rank(left ? p->lChild : p->rChild) == 2)
+    {
+      Node *y = left ? p->rChild : p->lChild;
+
+      if (y->rank == p->rank)
+      {
+        // red sibling: after the rotation p is red and has a black sibling
+        tree.rotateUp(y);
+        continue;
+      }
+
+      Node *inner = left ? y->lChild : y->rChild;
+      Node *outer = left ? y->rChild : y->lChild;
+
+      if (rank(outer) == y->rank)
+      {
+        tree.rotateUp(y);
+        ++y->rank;
+        --p->rank;
+        return;
+      }
+
+      if (rank(inner) == y->rank)
+      {
+        tree.rotateUp(inner);
+        tree.rotateUp(inner);
+        ++inner->rank;
+        --p->rank;
+        return;
+      }
+
+      --p->rank;
+      left = p->parent && p->parent->lChild == p;
+      p = p->parent;
+    }
+  }
+};
+
+} // namespace aisdi
+
+#endif /* AISDI_MAPS_TREEBALANCING_H */
@@ -1,20 +1,37 @@
 #ifndef AISDI_MAPS_TREEMAP_H
 #define AISDI_MAPS_TREEMAP_H
 
+#include <algorithm>
 #include <cstddef>
+#include <functional>
 #include <initializer_list>
+#include <iterator>
 #include <stdexcept>
+#include <type_traits>
 #include <utility>
+#include <vector>
+
+#include "FrozenTreeMap.h"
+#include "TaskPool.h"
+#include "TreeBalancing.h"
 
 namespace aisdi
 {
 
-template <typename KeyType, typename ValueType>
+// Compare is either a strict weak ordering like std::less or a three-way comparator returning
+// a negative, zero or positive number; a transparent Compare (one defining is_transparent)
+// also allows find() and valueOf() with keys of other types.
+// Balancing is AvlBalancing, WavlBalancing or RedBlackBalancing (see TreeBalancing.h).
+// Threaded nodes additionally link to their in-order neighbours, so iterator steps are a single load
+// at the cost of two pointers per node.
+template <typename KeyType, typename ValueType, typename Compare = std::less<KeyType>, typename Balancing = AvlBalancing,
+          bool Threaded = false>
 class TreeMap
 {
 public:
   using key_type = KeyType;
   using mapped_type = ValueType;
+  using key_compare = Compare;
   using value_type = std::pair<key_type, mapped_type>;
   using size_type = std::size_t;
   using reference = value_type &;
@@ -26,32 +43,86 @@ public:
   using const_iterator = ConstIterator;
 
 private:
-  struct Node
+  friend Balancing;
+
+  struct Node;
+
+  struct NoLinks
+  {
+  };
+
+  // in-order neighbours, rotations keep them valid
+  struct InOrderLinks
+  {
+    Node *prev = nullptr;
+    Node *next = nullptr;
+  };
+
+  struct Node : std::conditional_t<Threaded, InOrderLinks, NoLinks>
   {
     value_type value;
-    int height;
+    int rank; // maintained by Balancing, the height for AVL
     Node *lChild, *rChild, *parent;
 
-    Node(value_type value)
-        : value(value), height(1), lChild(nullptr), rChild(nullptr), parent(nullptr) {}
+    Node(const value_type &value)
+        : value(value), rank(1), lChild(nullptr), rChild(nullptr), parent(nullptr) {}
+
+    Node(const key_type &key, const mapped_type &mapped)
+        : value(key, mapped), rank(1), lChild(nullptr), rChild(nullptr), parent(nullptr) {}
   };
 
   int size = 0;
   Node *root = nullptr;
   Node *pBegin = nullptr;
   Node *pEnd = nullptr;
+  Compare compare;
+
+  static constexpr bool isThreeWay =
+      !std::is_same_v<std::decay_t<std::invoke_result_t<const Compare &, const key_type &, const key_type &>>, bool>;
+
+  template <typename A, typename B>
+  bool less(const A &a, const B &b) const
+  {
+    if constexpr (isThreeWay)
+    {
+      return compare(a, b) < 0;
+    }
+    else
+    {
+      return compare(a, b);
+    }
+  }
+
+  // std::less on arithmetic keys, where == agrees with the ordering and costs no more than <
+  template <typename K>
+  static constexpr bool isNaturalOrder =
+      (std::is_same_v<Compare, std::less<key_type>> || std::is_same_v<Compare, std::less<>>) &&
+      std::is_arithmetic_v<key_type> && std::is_arithmetic_v<K>;
 
-  int height(Node *n)
+  // negative, zero or positive; a single call of a three-way comparator, at most two of a less-than one
+  template <typename A, typename B>
+  int order(const A &a, const B &b) const
   {
-    return n ? n->height : 0;
+    if constexpr (isThreeWay)
+    {
+      auto result = compare(a, b);
+      return result < 0 ? -1 : (result > 0 ? 1 : 0);
+    }
+    else
+    {
+      return compare(a, b) ? -1 : (compare(b, a) ? 1 : 0);
+    }
   }
 
-  int heightDifference(Node *n)
+  // split, join and the set operations below use the AVL join algorithm, other policies rebuild the tree
+  static constexpr bool hasJoin = std::is_same_v<Balancing, AvlBalancing>;
+
+  static int rank(Node *n)
   {
-    return n ? (height(n->lChild) - height(n->rChild)) : 0;
+    return n ? n->rank : 0;
   }
 
-  key_type getKey(Node *n) const
+  const key_type &getKey(const Node *n) const
   {
     return n->value.first;
   }
@@ -90,27 +161,153 @@ private:
     return nullptr;
   }
 
-  Node *findNode(const key_type &key) const
+  static Node *predecessor(Node *n)
   {
-    Node *tmp = this->root;
+    if constexpr (Threaded)
+    {
+      return n->prev;
+    }
 
-    while (tmp != nullptr)
+    if (n->lChild)
     {
-      if (getKey(tmp) == key)
+      n = n->lChild;
+
+      while (n->rChild)
       {
-        break;
+        n = n->rChild;
       }
-      else if (getKey(tmp) < key)
+
+      return n;
+    }
+
+    while (n->parent && n != n->parent->rChild)
+    {
+      n = n->parent;
+    }
+
+    return n->parent;
+  }
+
+  static Node *successor(Node *n)
+  {
+    if constexpr (Threaded)
+    {
+      return n->next;
+    }
+
+    if (n->rChild)
+    {
+      n = n->rChild;
+
+      while (n->lChild)
       {
-        tmp = tmp->rChild;
+        n = n->lChild;
       }
-      else
+
+      return n;
+    }
+
+    while (n->parent && n != n->parent->lChild)
+    {
+      n = n->parent;
+    }
+
+    return n->parent;
+  }
+
+#ifndef NDEBUG
+  // checks n's subtree, previous is the node visited before it in order
+  void checkSubtree(const Node *n, const Node *parent, const Node *&previous, int &count) const
+  {
+    if (!n)
+    {
+      return;
+    }
+
+    if (n->parent != parent)
+    {
+      throw std::logic_error("Parent link does not point to the parent");
+    }
+
+    if (!Balancing::hasValidRanks(n))
+    {
+      throw std::logic_error("Ranks break the balancing rules");
+    }
+
+    checkSubtree(n->lChild, n, previous, count);
+
+    if (previous && !less(getKey(previous), getKey(n)))
+    {
+      throw std::logic_error("Keys are not in increasing order");
+    }
+
+    if constexpr (Threaded)
+    {
+      if (n->prev != previous || (previous && previous->next != n))
       {
-        tmp = tmp->lChild;
+        throw std::logic_error("In-order threads do not link neighbours");
       }
     }
 
-    return tmp;
+    previous = n;
+    ++count;
+
+    checkSubtree(n->rChild, n, previous, count);
+  }
+#endif
+
+  // one comparison per level
+  template <typename K>
+  Node *findNode(const K &key) const
+  {
+    Node *current = root;
+
+    if constexpr (isThreeWay)
+    {
+      while (current)
+      {
+        auto result = compare(key, getKey(current));
+
+        if (result == 0)
+        {
+          break;
+        }
+
+        current = result < 0 ? current->lChild : current->rChild;
+      }
+
+      return current;
+    }
+    else if constexpr (isNaturalOrder<K>)
+    {
+      // equality is nearly free here and the child is picked with a conditional move, not a branch
+      while (current && !(getKey(current) == key))
+      {
+        current = compare(getKey(current), key) ? current->rChild : current->lChild;
+      }
+
+      return current;
+    }
+    else
+    {
+      // the last node where the descent went right is the only one that can be equal to key
+      Node *candidate = nullptr;
+
+      while (current)
+      {
+        if (compare(key, getKey(current)))
+        {
+          current = current->lChild;
+        }
+        else
+        {
+          candidate = current;
+          current = current->rChild;
+        }
+      }
+
+      return (candidate && !compare(getKey(candidate), key)) ? candidate : nullptr;
+    }
   }
 
   Node *LL(Node *n)
@@ -133,8 +330,8 @@ private:
     }
 
     // update heights
-    n->height = std::max(height(n->lChild), height(n->rChild)) + 1;
-    m->height = std::max(height(m->lChild), height(m->rChild)) + 1;
+    n->rank = std::max(rank(n->lChild), rank(n->rChild)) + 1;
+    m->rank = std::max(rank(m->lChild), rank(m->rChild)) + 1;
 
     return m;
   }
@@ -159,211 +356,196 @@ private:
     }
 
     // update heights
-    n->height = std::max(height(n->lChild), height(n->rChild)) + 1;
-    m->height = std::max(height(m->lChild), height(m->rChild)) + 1;
+    n->rank = std::max(rank(n->lChild), rank(n->rChild)) + 1;
+    m->rank = std::max(rank(m->lChild), rank(m->rChild)) + 1;
 
     return m;
   }
 
-  Node *insert(value_type value, Node *current)
+  // links replacement (possibly nullptr) where n hangs below its parent, or makes it the root
+  void replaceChild(Node *n, Node *replacement)
   {
-    if (current == nullptr)
-    {
-      ++size;
-      Node *newNode = new Node(value);
-
-      // set new pBegin and pEnd if necessary
-      if (size == 1)
-      {
-        pBegin = pEnd = newNode;
-      }
-      else if (getKey(newNode) < getKey(pBegin))
-      {
-        pBegin = newNode;
-      }
-      else if (getKey(newNode) > getKey(pEnd))
-      {
-        pEnd = newNode;
-      }
+    Node *parent = n->parent;
 
-      return newNode;
+    if (parent == nullptr)
+    {
+      root = replacement;
     }
-
-    if (value.first < getKey(current))
+    else if (parent->lChild == n)
+    {
+      parent->lChild = replacement;
+    }
+    else
     {
-      current->lChild = insert(value, current->lChild);
+      parent->rChild = replacement;
+    }
 
-      if (current->lChild)
-      {
-        current->lChild->parent = current;
-      }
+    if (replacement)
+    {
+      replacement->parent = parent;
     }
-    else if (value.first > getKey(current))
+  }
+
+  // rotates n above its parent for Balancing, which also updates the ranks
+  void rotateUp(Node *n)
+  {
+    Node *parent = n->parent;
+
+    if (parent->lChild == n)
     {
-      current->rChild = insert(value, current->rChild);
+      parent->lChild = n->rChild;
 
-      if (current->rChild)
+      if (n->rChild)
       {
-        current->rChild->parent = current;
+        n->rChild->parent = parent;
       }
+
+      n->rChild = parent;
     }
     else
     {
-      return current;
-    }
-
-    // update height
-    current->height = std::max(height(current->lChild), height(current->rChild)) + 1;
+      parent->rChild = n->lChild;
 
-    // check if it is still balanced
-    int balance = heightDifference(current);
+      if (n->lChild)
+      {
+        n->lChild->parent = parent;
+      }
 
-    // balance tree
-    if (balance > 1 && value.first < getKey(current->lChild))
-    {
-      return LL(current);
+      n->lChild = parent;
     }
 
-    if (balance < -1 && value.first > getKey(current->rChild))
-    {
-      return RR(current);
-    }
+    replaceChild(parent, n);
+    parent->parent = n;
+  }
 
-    if (balance > 1 && value.first > getKey(current->lChild))
+  static void linkBetween(Node *n, Node *previous, Node *next)
+  {
+    n->prev = previous;
+    n->next = next;
+
+    if (previous)
     {
-      current->lChild = RR(current->lChild);
-      return LL(current);
+      previous->next = n;
     }
 
-    if (balance < -1 && value.first < getKey(current->rChild))
+    if (next)
     {
-      current->rChild = LL(current->rChild);
-      return RR(current);
+      next->prev = n;
     }
-
-    return current;
   }
 
-  Node *remove(key_type key, Node *current)
+  // attaches a new leaf as the given child of parent, which must be free and the right place for key;
+  // a nullptr parent makes it the root of an empty tree
+  Node *insertAt(Node *parent, bool asLeftChild, const key_type &key, const mapped_type &value)
   {
-    if (current == nullptr)
+    Node *newNode = new Node(key, value);
+    newNode->parent = parent;
+    ++size;
+
+    if (parent == nullptr)
     {
-      return current;
+      root = pBegin = pEnd = newNode;
     }
-
-    if (key < getKey(current))
+    else if (asLeftChild)
     {
-      current->lChild = remove(key, current->lChild);
+      parent->lChild = newNode;
 
-      if (current->lChild)
+      if (parent == pBegin)
       {
-        current->lChild->parent = current;
+        pBegin = newNode;
       }
-    }
-    else if (key > getKey(current))
-    {
-      current->rChild = remove(key, current->rChild);
 
-      if (current->rChild)
+      if constexpr (Threaded)
       {
-        current->rChild->parent = current;
+        linkBetween(newNode, parent->prev, parent);
       }
     }
     else
-    { // node to be deleted
-      --size;
+    {
+      parent->rChild = newNode;
 
-      // node with 0/1 child
-      if ((current->lChild == nullptr) || (current->rChild == nullptr))
+      if (parent == pEnd)
       {
-        Node *tmp = current->lChild ? current->lChild : current->rChild;
+        pEnd = newNode;
+      }
 
-        // 0 child case (leaf)
-        if (tmp == nullptr)
-        {
+      if constexpr (Threaded)
+      {
+        linkBetween(newNode, parent, parent->next);
+      }
+    }
 
-          // set new pBegin if necessary
-          if (current == pBegin)
-          {
-            pBegin = current->parent;
-          }
+    Balancing::afterInsert(*this, newNode);
 
-          //set new pEnd if necessary
-          if (current == pEnd)
-          {
-            pEnd = current->parent;
-          }
+    return newNode;
+  }
 
-          tmp = current;
-          current = nullptr;
-        }
-        else
-        { // 1 child case
+  // unlinks and deletes n; a node with two children is replaced by its successor node, so no value is copied
+  void removeNode(Node *n)
+  {
+    if (n == pBegin)
+    {
+      pBegin = successor(n);
+    }
 
-          // set new pBegin if necessary
-          if (current->lChild == pBegin)
-          {
-            pBegin = current;
-          }
+    if (n == pEnd)
+    {
+      pEnd = predecessor(n);
+    }
 
-          //set new pEnd if necessary
-          if (current->rChild == pEnd)
-          {
-            pEnd = current;
-          }
+    // the subtree on one side of shrunk has lost a node
+    Node *shrunk = n->parent;
+    bool shrunkLeft = shrunk && shrunk->lChild == n;
 
-          current->value = tmp->value;
-          current->lChild = current->rChild = nullptr;
-        }
+    if (n->lChild && n->rChild)
+    {
+      Node *next = successor(n);
 
-        delete tmp;
+      if (next->parent == n)
+      {
+        shrunk = next;
+        shrunkLeft = false;
       }
       else
-      { // node with two children
-        Node *tmp = smallestNode(current->rChild);
-
-        current->value = tmp->value; // copy data
+      {
+        shrunk = next->parent;
+        shrunkLeft = true;
 
-        current->rChild = remove(getKey(tmp), current->rChild); // delete inorder successor
+        replaceChild(next, next->rChild);
+        next->rChild = n->rChild;
+        next->rChild->parent = next;
       }
-    }
 
-    // tree had one node
-    if (current == nullptr)
-    {
-      return current;
+      next->lChild = n->lChild;
+      next->lChild->parent = next;
+      next->rank = n->rank;
+      replaceChild(n, next);
     }
-
-    // update height
-    current->height = std::max(height(current->lChild), height(current->rChild)) + 1;
-
-    // check if it is still balanced
-    int balance = heightDifference(current);
-
-    // balance tree
-    if (balance > 1 && heightDifference(current->lChild) >= 0)
+    else
     {
-      return LL(current);
+      replaceChild(n, n->lChild ? n->lChild : n->rChild);
     }
 
-    if (balance > 1 && heightDifference(current->lChild) < 0)
+    if constexpr (Threaded)
     {
-      current->lChild = RR(current->lChild);
-      return LL(current);
-    }
+      if (n->prev)
+      {
+        n->prev->next = n->next;
+      }
 
-    if (balance < -1 && heightDifference(current->rChild) <= 0)
-    {
-      return RR(current);
+      if (n->next)
+      {
+        n->next->prev = n->prev;
+      }
     }
 
-    if (balance < -1 && heightDifference(current->rChild) > 0)
+    delete n;
+    --size;
+
+    if (shrunk)
     {
-      current->rChild = LL(current->rChild);
-      return RR(current);
+      Balancing::afterRemove(*this, shrunk, shrunkLeft);
     }
-
-    return current;
   }
 
   void removeTree(Node *n)
@@ -381,7 +563,7 @@ private:
     if (node)
     {
       Node *newNode = new Node(node->value);
-      newNode->height = node->height;
+      newNode->rank = node->rank;
       newNode->parent = parent;
 
       if (node->lChild)
@@ -400,103 +582,848 @@ private:
     return nullptr;
   }
 
-public:
-  Node *pEndReturn() const
+  struct SplitResult
   {
-    return pEnd;
-  }
-
-  TreeMap() = default;
+    Node *left;
+    Node *middle;
+    Node *right;
+  };
 
-  TreeMap(std::initializer_list<value_type> list)
+  // makes middle the root of left and right, middle must be detached
+  Node *attach(Node *left, Node *middle, Node *right)
   {
-    for (auto [key, value] : list)
+    middle->lChild = left;
+    middle->rChild = right;
+    middle->parent = nullptr;
+
+    if (left)
     {
-      (*this)[key] = value;
+      left->parent = middle;
     }
-  }
 
-  TreeMap(const TreeMap &other)
-      : size(other.size)
-  {
-    root = makeCopy(other.root, nullptr);
-    pBegin = smallestNode(root);
-    pEnd = highestNode(root);
-  }
+    if (right)
+    {
+      right->parent = middle;
+    }
 
-  TreeMap(TreeMap &&other)
-      : size(other.size), root(std::exchange(other.root, nullptr)), pBegin(std::exchange(other.pBegin, nullptr)), pEnd(std::exchange(other.pEnd, nullptr)) {}
+    middle->rank = std::max(rank(left), rank(right)) + 1;
 
-  ~TreeMap()
-  {
-    removeTree(root);
+    return middle;
   }
 
-  TreeMap &operator=(const TreeMap &other)
+  Node *joinRight(Node *left, Node *middle, Node *right)
   {
-    if (this == &other)
+    Node *spine = left->rChild;
+
+    if (rank(spine) <= rank(right) + 1)
     {
-      return *this;
-    }
+      Node *joined = attach(spine, middle, right);
 
-    removeTree(root);
+      if (rank(joined) <= rank(left->lChild) + 1)
+      {
+        return attach(left->lChild, left, joined);
+      }
 
-    size = other.size;
+      return RR(attach(left->lChild, left, LL(joined)));
+    }
 
-    root = makeCopy(other.root, nullptr);
-    pBegin = smallestNode(root);
-    pEnd = highestNode(root);
+    Node *joined = joinRight(spine, middle, right);
+    Node *result = attach(left->lChild, left, joined);
 
-    return *this;
+    if (rank(joined) <= rank(left->lChild) + 1)
+    {
+      return result;
+    }
+
+    return RR(result);
   }
 
-  TreeMap &operator=(TreeMap &&other)
+  Node *joinLeft(Node *left, Node *middle, Node *right)
   {
-    if (this == &other)
+    Node *spine = right->lChild;
+
+    if (rank(spine) <= rank(left) + 1)
     {
-      return *this;
-    }
+      Node *joined = attach(left, middle, spine);
 
-    removeTree(root);
+      if (rank(joined) <= rank(right->rChild) + 1)
+      {
+        return attach(joined, right, right->rChild);
+      }
 
-    size = other.size;
+      return LL(attach(RR(joined), right, right->rChild));
+    }
 
-    root = std::exchange(other.root, nullptr);
-    pBegin = std::exchange(other.pBegin, nullptr);
-    pEnd = std::exchange(other.pEnd, nullptr);
+    Node *joined = joinLeft(left, middle, spine);
+    Node *result = attach(joined, right, right->rChild);
 
-    return *this;
-  }
+    if (rank(joined) <= rank(right->rChild) + 1)
+    {
+      return result;
+    }
 
-  bool isEmpty() const
-  {
-    return !size;
+    return LL(result);
   }
 
-  mapped_type &operator[](const key_type &key)
+  // all keys in left must be smaller than middle's key and all keys in right greater, O(|h(left) - h(right)|)
+  Node *join(Node *left, Node *middle, Node *right)
   {
-    auto result = find(key);
-
-    if (result != end())
+    if (rank(left) > rank(right) + 1)
     {
-      return result->second;
+      return joinRight(left, middle, right);
     }
 
-    root = insert({key, mapped_type()}, root);
+    if (rank(right) > rank(left) + 1)
+    {
+      return joinLeft(left, middle, right);
+    }
 
-    return find(key)->second;
+    return attach(left, middle, right);
   }
 
-  const mapped_type &valueOf(const key_type &key) const
+  Node *detachChild(Node *child)
   {
-    auto result = find(key);
-
-    if (result == end())
+    if (child)
     {
-      throw std::out_of_range("Value not found!");
+      child->parent = nullptr;
     }
 
-    return result->second;
+    return child;
+  }
+
+  std::pair<Node *, Node *> splitLast(Node *n)
+  {
+    Node *left = detachChild(n->lChild);
+    Node *right = detachChild(n->rChild);
+
+    if (right == nullptr)
+    {
+      return {left, attach(nullptr, n, nullptr)};
+    }
+
+    auto [rest, last] = splitLast(right);
+
+    return {join(left, n, rest), last};
+  }
+
+  // join without a middle node, all keys in left must be smaller than keys in right
+  Node *join2(Node *left, Node *right)
+  {
+    if (left == nullptr)
+    {
+      return right;
+    }
+
+    if (right == nullptr)
+    {
+      return left;
+    }
+
+    auto [rest, last] = splitLast(left);
+
+    return join(rest, last, right);
+  }
+
+  // splits into keys smaller than key, node with key (or nullptr) and keys greater than key, O(log n)
+  SplitResult split(Node *n, const key_type &key)
+  {
+    if (n == nullptr)
+    {
+      return {nullptr, nullptr, nullptr};
+    }
+
+    Node *left = detachChild(n->lChild);
+    Node *right = detachChild(n->rChild);
+
+    int direction = order(key, getKey(n));
+
+    if (direction < 0)
+    {
+      SplitResult result = split(left, key);
+      return {result.left, result.middle, join(result.right, n, right)};
+    }
+
+    if (direction > 0)
+    {
+      SplitResult result = split(right, key);
+      return {join(left, n, result.left), result.middle, result.right};
+    }
+
+    return {left, attach(nullptr, n, nullptr), right};
+  }
+
+  // keeps values from mine on key collision, nodes of theirs are copied
+  Node *unite(Node *mine, Node *theirs, size_type &matches)
+  {
+    if (theirs == nullptr)
+    {
+      return mine;
+    }
+
+    if (mine == nullptr)
+    {
+      return makeCopy(theirs, nullptr);
+    }
+
+    SplitResult parts = split(mine, getKey(theirs));
+
+    Node *left = unite(parts.left, theirs->lChild, matches);
+    Node *right = unite(parts.right, theirs->rChild, matches);
+    Node *middle = parts.middle;
+
+    if (middle)
+    {
+      ++matches;
+    }
+    else
+    {
+      middle = new Node(theirs->value);
+    }
+
+    return join(left, middle, right);
+  }
+
+  // keeps values from mine on key collision, nodes of theirs are reused
+  Node *merge(Node *mine, Node *theirs, size_type &matches)
+  {
+    if (theirs == nullptr)
+    {
+      return mine;
+    }
+
+    if (mine == nullptr)
+    {
+      return theirs;
+    }
+
+    Node *theirsLeft = detachChild(theirs->lChild);
+    Node *theirsRight = detachChild(theirs->rChild);
+
+    SplitResult parts = split(mine, getKey(theirs));
+
+    Node *left = merge(parts.left, theirsLeft, matches);
+    Node *right = merge(parts.right, theirsRight, matches);
+    Node *middle = theirs;
+
+    if (parts.middle)
+    {
+      ++matches;
+      delete theirs;
+      middle = parts.middle;
+    }
+
+    return join(left, middle, right);
+  }
+
+  Node *intersect(Node *mine, Node *theirs, size_type &matches)
+  {
+    if (mine == nullptr)
+    {
+      return nullptr;
+    }
+
+    if (theirs == nullptr)
+    {
+      removeTree(mine);
+      return nullptr;
+    }
+
+    SplitResult parts = split(mine, getKey(theirs));
+
+    Node *left = intersect(parts.left, theirs->lChild, matches);
+    Node *right = intersect(parts.right, theirs->rChild, matches);
+
+    if (parts.middle)
+    {
+      ++matches;
+      return join(left, parts.middle, right);
+    }
+
+    return join2(left, right);
+  }
+
+  Node *subtract(Node *mine, Node *theirs, size_type &matches)
+  {
+    if (mine == nullptr || theirs == nullptr)
+    {
+      return mine;
+    }
+
+    SplitResult parts = split(mine, getKey(theirs));
+
+    Node *left = subtract(parts.left, theirs->lChild, matches);
+    Node *right = subtract(parts.right, theirs->rChild, matches);
+
+    if (parts.middle)
+    {
+      ++matches;
+      delete parts.middle;
+    }
+
+    return join2(left, right);
+  }
+
+  // counts nodes of the smaller tree in O(min(|first|, |second|)), true if first is the smaller one
+  std::pair<size_type, bool> countSmaller(Node *first, Node *second) const
+  {
+    Node *a = smallestNode(first);
+    Node *b = smallestNode(second);
+    size_type count = 0;
+
+    while (a && b)
+    {
+      a = successor(a);
+      b = successor(b);
+      ++count;
+    }
+
+    return {count, a == nullptr};
+  }
+
+  // the in-order links of a threaded tree must already be correct
+  void setRoot(Node *newRoot, size_type newSize)
+  {
+    root = newRoot;
+    size = newSize;
+    pBegin = smallestNode(root);
+    pEnd = highestNode(root);
+  }
+
+  static void threadSubtree(Node *n, Node *&previous)
+  {
+    if (n)
+    {
+      threadSubtree(n->lChild, previous);
+      linkBetween(n, previous, nullptr);
+      previous = n;
+      threadSubtree(n->rChild, previous);
+    }
+  }
+
+  // relinks the in-order neighbours of the whole tree in O(n), a no-op for non-threaded trees
+  void threadTree()
+  {
+    if constexpr (Threaded)
+    {
+      Node *previous = nullptr;
+      threadSubtree(root, previous);
+    }
+  }
+
+  void resetRoot(Node *newRoot, size_type newSize)
+  {
+    setRoot(newRoot, newSize);
+    threadTree();
+  }
+
+  // descents interleaved by findMany, about as many cache misses as a core keeps in flight
+  static constexpr size_type findManyWidth = 16;
+
+  // subtrees not higher than this are processed sequentially by parallel operations
+  static constexpr int parallelGrainHeight = 12;
+
+  void removeTree(Node *n, TaskPool &pool)
+  {
+    if (rank(n) <= parallelGrainHeight)
+    {
+      removeTree(n);
+      return;
+    }
+
+    pool.invoke([&] { removeTree(n->lChild, pool); },
+                [&] { removeTree(n->rChild, pool); });
+    delete n;
+  }
+
+  Node *makeCopy(Node *node, Node *parent, TaskPool &pool)
+  {
+    if (rank(node) <= parallelGrainHeight)
+    {
+      return makeCopy(node, parent);
+    }
+
+    Node *newNode = new Node(node->value);
+    newNode->rank = node->rank;
+    newNode->parent = parent;
+
+    pool.invoke([&] { newNode->lChild = makeCopy(node->lChild, newNode, pool); },
+                [&] { newNode->rChild = makeCopy(node->rChild, newNode, pool); });
+
+    return newNode;
+  }
+
+  template <typename RandomIt>
+  Node *buildFromSorted(RandomIt first, size_type count, Node *parent, TaskPool &pool)
+  {
+    if (count < (size_type(1) << parallelGrainHeight))
+    {
+      return buildFromSorted(first, count, parent);
+    }
+
+    size_type leftCount = (count - 1) / 2;
+
+    Node *newNode = new Node(first[leftCount]);
+    newNode->parent = parent;
+
+    pool.invoke([&] { newNode->lChild = buildFromSorted(first, leftCount, newNode, pool); },
+                [&] { newNode->rChild = buildFromSorted(first + leftCount + 1, count - 1 - leftCount, newNode, pool); });
+
+    newNode->rank = Balancing::builtRank(rank(newNode->lChild), rank(newNode->rChild));
+
+    return newNode;
+  }
+
+  Node *unite(Node *mine, Node *theirs, size_type &matches, TaskPool &pool)
+  {
+    if (std::min(rank(mine), rank(theirs)) <= parallelGrainHeight)
+    {
+      return unite(mine, theirs, matches);
+    }
+
+    SplitResult parts = split(mine, getKey(theirs));
+
+    Node *left = nullptr;
+    Node *right = nullptr;
+    size_type rightMatches = 0;
+
+    pool.invoke([&] { left = unite(parts.left, theirs->lChild, matches, pool); },
+                [&] { right = unite(parts.right, theirs->rChild, rightMatches, pool); });
+
+    matches += rightMatches;
+    Node *middle = parts.middle;
+
+    if (middle)
+    {
+      ++matches;
+    }
+    else
+    {
+      middle = new Node(theirs->value);
+    }
+
+    return join(left, middle, right);
+  }
+
+  Node *intersect(Node *mine, Node *theirs, size_type &matches, TaskPool &pool)
+  {
+    if (std::min(rank(mine), rank(theirs)) <= parallelGrainHeight)
+    {
+      return intersect(mine, theirs, matches);
+    }
+
+    SplitResult parts = split(mine, getKey(theirs));
+
+    Node *left = nullptr;
+    Node *right = nullptr;
+    size_type rightMatches = 0;
+
+    pool.invoke([&] { left = intersect(parts.left, theirs->lChild, matches, pool); },
+                [&] { right = intersect(parts.right, theirs->rChild, rightMatches, pool); });
+
+    matches += rightMatches;
+
+    if (parts.middle)
+    {
+      ++matches;
+      return join(left, parts.middle, right);
+    }
+
+    return join2(left, right);
+  }
+
+  template <typename InputIt>
+  Node *buildFromSorted(InputIt &it, size_type count, Node *parent)
+  {
+    if (count == 0)
+    {
+      return nullptr;
+    }
+
+    // middle element becomes the root, so subtree heights differ by at most one
+    size_type leftCount = (count - 1) / 2;
+
+    Node *left = buildFromSorted(it, leftCount, nullptr);
+    Node *newNode = new Node(*it);
+    ++it;
+
+    newNode->parent = parent;
+    newNode->lChild = left;
+
+    if (left)
+    {
+      left->parent = newNode;
+    }
+
+    newNode->rChild = buildFromSorted(it, count - 1 - leftCount, newNode);
+    newNode->rank = Balancing::builtRank(rank(newNode->lChild), rank(newNode->rChild));
+
+    return newNode;
+  }
+
+  template <typename ForwardIt>
+  void assignFromSorted(ForwardIt first, ForwardIt last)
+  {
+    size_type count = std::distance(first, last);
+
+    resetRoot(buildFromSorted(first, count, nullptr), count);
+  }
+
+  template <typename ForwardIt>
+  bool isStrictlySorted(ForwardIt first, ForwardIt last) const
+  {
+    if (first == last)
+    {
+      return true;
+    }
+
+    for (ForwardIt next = std::next(first); next != last; ++first, ++next)
+    {
+      if (!less(first->first, next->first))
+      {
+        return false;
+      }
+    }
+
+    return true;
+  }
+
+  // Bulk operations for policies without a join relink the in-order node sequence in O(n + m).
+
+  static void collectNodes(Node *n, std::vector<Node *> &nodes)
+  {
+    if (n)
+    {
+      collectNodes(n->lChild, nodes);
+      nodes.push_back(n);
+      collectNodes(n->rChild, nodes);
+    }
+  }
+
+  static Node *linkSorted(Node **first, size_type count, Node *parent)
+  {
+    if (count == 0)
+    {
+      return nullptr;
+    }
+
+    size_type leftCount = (count - 1) / 2;
+    Node *n = first[leftCount];
+
+    n->parent = parent;
+    n->lChild = linkSorted(first, leftCount, n);
+    n->rChild = linkSorted(first + leftCount + 1, count - 1 - leftCount, n);
+    n->rank = Balancing::builtRank(rank(n->lChild), rank(n->rChild));
+
+    return n;
+  }
+
+  void resetNodes(std::vector<Node *> &nodes)
+  {
+    resetRoot(linkSorted(nodes.data(), nodes.size(), nullptr), nodes.size());
+  }
+
+  enum class SetOperation
+  {
+    unite,
+    merge,
+    intersect,
+    subtract
+  };
+
+  // keeps values from mine on key collision, merge reuses and unite copies nodes of theirs
+  void rebuild(Node *theirsRoot, SetOperation operation)
+  {
+    std::vector<Node *> mine, theirs, kept;
+    collectNodes(root, mine);
+    collectNodes(theirsRoot, theirs);
+
+    for (size_type i = 0, j = 0; i < mine.size() || j < theirs.size();)
+    {
+      int direction = (i == mine.size()) ? 1 : (j == theirs.size() ? -1 : order(getKey(mine[i]), getKey(theirs[j])));
+
+      if (direction < 0)
+      {
+        if (operation == SetOperation::intersect)
+        {
+          delete mine[i];
+        }
+        else
+        {
+          kept.push_back(mine[i]);
+        }
+
+        ++i;
+      }
+      else if (direction > 0)
+      {
+        if (operation == SetOperation::unite)
+        {
+          kept.push_back(new Node(theirs[j]->value));
+        }
+        else if (operation == SetOperation::merge)
+        {
+          kept.push_back(theirs[j]);
+        }
+
+        ++j;
+      }
+      else
+      {
+        if (operation == SetOperation::subtract)
+        {
+          delete mine[i];
+        }
+        else
+        {
+          kept.push_back(mine[i]);
+        }
+
+        if (operation == SetOperation::merge)
+        {
+          delete theirs[j];
+        }
+
+        ++i;
+        ++j;
+      }
+    }
+
+    resetNodes(kept);
+  }
+
+public:
+  Node *pEndReturn() const
+  {
+    return pEnd;
+  }
+
+  TreeMap() = default;
+
+  explicit TreeMap(const Compare &compare)
+      : compare(compare) {}
+
+  TreeMap(std::initializer_list<value_type> list)
+      : TreeMap(list.begin(), list.end()) {}
+
+  // Builds the tree in linear time when the range is already strictly sorted,
+  // otherwise inserts items one by one (later duplicates overwrite earlier ones).
+  template <typename InputIt>
+  TreeMap(InputIt first, InputIt last)
+  {
+    using category = typename std::iterator_traits<InputIt>::iterator_category;
+
+    if constexpr (std::is_base_of_v<std::forward_iterator_tag, category>)
+    {
+      if (isStrictlySorted(first, last))
+      {
+        assignFromSorted(first, last);
+        return;
+      }
+    }
+
+    for (; first != last; ++first)
+    {
+      (*this)[first->first] = first->second;
+    }
+  }
+
+  // Parallel variant of the range constructor, an unsorted range is stable-sorted first.
+  template <typename RandomIt>
+  TreeMap(RandomIt first, RandomIt last, TaskPool &pool)
+  {
+    if (isStrictlySorted(first, last))
+    {
+      resetRoot(buildFromSorted(first, std::distance(first, last), nullptr, pool), std::distance(first, last));
+      return;
+    }
+
+    std::vector<value_type> items(first, last);
+    std::stable_sort(items.begin(), items.end(), [this](const value_type &a, const value_type &b) { return less(a.first, b.first); });
+
+    // keep the last of equal keys, like repeated assignment would
+    auto kept = items.begin();
+
+    for (auto it = items.begin(); it != items.end(); ++it)
+    {
+      if (std::next(it) == items.end() || less(it->first, std::next(it)->first))
+      {
+        *kept++ = std::move(*it);
+      }
+    }
+
+    items.erase(kept, items.end());
+    resetRoot(buildFromSorted(items.begin(), items.size(), nullptr, pool), items.size());
+  }
+
+  // Builds a perfectly balanced tree in O(n); keys in [first, last) must be strictly increasing.
+  template <typename InputIt>
+  static TreeMap fromSorted(InputIt first, InputIt last)
+  {
+    using category = typename std::iterator_traits<InputIt>::iterator_category;
+
+    TreeMap result;
+
+    if constexpr (std::is_base_of_v<std::forward_iterator_tag, category>)
+    {
+      result.assignFromSorted(first, last);
+    }
+    else
+    {
+      std::vector<value_type> items(first, last);
+      result.assignFromSorted(items.begin(), items.end());
+    }
+
+    return result;
+  }
+
+  // Parallel variant of fromSorted, subtrees are built by the pool's threads.
+  template <typename RandomIt>
+  static TreeMap fromSorted(RandomIt first, RandomIt last, TaskPool &pool)
+  {
+    TreeMap result;
+    size_type count = std::distance(first, last);
+    result.resetRoot(result.buildFromSorted(first, count, nullptr, pool), count);
+
+    return result;
+  }
+
+  TreeMap(const TreeMap &other)
+      : compare(other.compare)
+  {
+    resetRoot(makeCopy(other.root, nullptr), other.size);
+  }
+
+  TreeMap(const TreeMap &other, TaskPool &pool)
+      : compare(other.compare)
+  {
+    resetRoot(makeCopy(other.root, nullptr, pool), other.size);
+  }
+
+  TreeMap(TreeMap &&other)
+      : size(other.size), root(std::exchange(other.root, nullptr)), pBegin(std::exchange(other.pBegin, nullptr)), pEnd(std::exchange(other.pEnd, nullptr)), compare(other.compare) {}
+
+  ~TreeMap()
+  {
+    removeTree(root);
+  }
+
+  TreeMap &operator=(const TreeMap &other)
+  {
+    if (this == &other)
+    {
+      return *this;
+    }
+
+    removeTree(root);
+
+    compare = other.compare;
+    resetRoot(makeCopy(other.root, nullptr), other.size);
+
+    return *this;
+  }
+
+  TreeMap &operator=(TreeMap &&other)
+  {
+    if (this == &other)
+    {
+      return *this;
+    }
+
+    removeTree(root);
+
+    size = other.size;
+    compare = other.compare;
+
+    root = std::exchange(other.root, nullptr);
+    pBegin = std::exchange(other.pBegin, nullptr);
+    pEnd = std::exchange(other.pEnd, nullptr);
+
+    return *this;
+  }
+
+  bool isEmpty() const
+  {
+    return !size;
+  }
+
+  mapped_type &operator[](const key_type &key)
+  {
+    // keys beyond either end, e.g. increasing timestamps, are attached there without a descent
+    if (pEnd && less(getKey(pEnd), key))
+    {
+      return insertAt(pEnd, false, key, mapped_type())->value.second;
+    }
+
+    if (pBegin && less(key, getKey(pBegin)))
+    {
+      return insertAt(pBegin, true, key, mapped_type())->value.second;
+    }
+
+    // candidate is the last node where the descent went right, the only one that can be equal to key,
+    // so each level costs one comparison also with a less-than Compare
+    Node *parent = nullptr;
+    Node *candidate = nullptr;
+    bool asLeftChild = false;
+
+    for (Node *current = root; current;)
+    {
+      parent = current;
+      asLeftChild = less(key, getKey(current));
+
+      if (asLeftChild)
+      {
+        current = current->lChild;
+      }
+      else
+      {
+        candidate = current;
+        current = current->rChild;
+      }
+    }
+
+    if (candidate && !less(getKey(candidate), key))
+    {
+      return candidate->value.second;
+    }
+
+    return insertAt(parent, asLeftChild, key, mapped_type())->value.second;
+  }
+
+  // Sets key to value, where hint is the position just after key (e.g. end() when appending).
+  // A correct hint costs O(1) comparisons and amortised O(1) rebalancing; a wrong one falls back to operator[].
+  iterator insertHint(const_iterator hint, const key_type &key, const mapped_type &value)
+  {
+    Node *next = hint.actualNode;
+
+    if (hint.map == this && size > 0)
+    {
+      Node *previous = next ? predecessor(next) : pEnd;
+
+      if ((previous == nullptr || less(getKey(previous), key)) && (next == nullptr || less(key, getKey(next))))
+      {
+        // key belongs between two neighbours, one of which has the needed child slot free
+        Node *newNode = (next && next->lChild == nullptr) ? insertAt(next, true, key, value)
+                                                          : insertAt(previous, false, key, value);
+
+        return iterator(const_iterator(this, newNode));
+      }
+    }
+
+    (*this)[key] = value;
+
+    return find(key);
+  }
+
+  const mapped_type &valueOf(const key_type &key) const
+  {
+    auto result = find(key);
+
+    if (result == end())
+    {
+      throw std::out_of_range("Value not found!");
+    }
+
+    return result->second;
   }
 
   mapped_type &valueOf(const key_type &key)
@@ -521,11 +1448,106 @@ public:
     return iterator(const_iterator(this, findNode(key)));
   }
 
+  template <typename K, typename C = Compare, typename = typename C::is_transparent>
+  const_iterator find(const K &key) const
+  {
+    return const_iterator(this, findNode(key));
+  }
+
+  template <typename K, typename C = Compare, typename = typename C::is_transparent>
+  iterator find(const K &key)
+  {
+    return iterator(const_iterator(this, findNode(key)));
+  }
+
+  template <typename K, typename C = Compare, typename = typename C::is_transparent>
+  const mapped_type &valueOf(const K &key) const
+  {
+    Node *result = findNode(key);
+
+    if (result == nullptr)
+    {
+      throw std::out_of_range("Value not found!");
+    }
+
+    return result->value.second;
+  }
+
+  // Finds every key of [first, last) and returns their iterators in the same order, cend() for missing keys.
+  // Up to findManyWidth descents advance in turns, each prefetching its next node before yielding,
+  // so on trees larger than the cache their misses overlap instead of being paid one after another.
+  template <typename RandomIt>
+  std::vector<const_iterator> findMany(RandomIt first, RandomIt last) const
+  {
+    struct Descent
+    {
+      Node *current;
+      Node *candidate;
+      size_type index;
+    };
+
+    size_type count = std::distance(first, last);
+    std::vector<const_iterator> results(count, cend());
+    Descent descents[findManyWidth];
+    size_type active = 0;
+    size_type next = 0;
+
+    for (; active < findManyWidth && next < count; ++active, ++next)
+    {
+      descents[active] = {root, nullptr, next};
+    }
+
+    while (active > 0)
+    {
+      for (size_type i = 0; i < active;)
+      {
+        Descent &descent = descents[i];
+        const auto &key = first[descent.index];
+
+        // one level of the same descent as in operator[]
+        if (descent.current)
+        {
+          if (less(key, getKey(descent.current)))
+          {
+            descent.current = descent.current->lChild;
+          }
+          else
+          {
+            descent.candidate = descent.current;
+            descent.current = descent.current->rChild;
+          }
+
+          __builtin_prefetch(descent.current);
+          ++i;
+          continue;
+        }
+
+        if (descent.candidate && !less(getKey(descent.candidate), key))
+        {
+          results[descent.index] = const_iterator(this, descent.candidate);
+        }
+
+        // the slot takes the next key, or the last active descent when none are left
+        if (next < count)
+        {
+          descent = {root, nullptr, next++};
+          ++i;
+        }
+        else
+        {
+          descent = descents[--active];
+        }
+      }
+    }
+
+    return results;
+  }
+
   void remove(const key_type &key)
   {
-    if (findNode(key))
+    if (Node *target = findNode(key))
     {
-      root = remove(key, root);
+      removeNode(target);
       return;
     }
 
@@ -534,7 +1556,12 @@ public:
 
   void remove(const const_iterator &it)
   {
-    remove(it->first);
+    if (it.map != this || it.actualNode == nullptr)
+    {
+      throw std::out_of_range("Removing end()!");
+    }
+
+    removeNode(it.actualNode);
   }
 
   size_type getSize() const
@@ -542,6 +1569,277 @@ public:
     return size;
   }
 
+  // Moves all items with keys not smaller than key into the returned map.
+  // Restructuring is O(log n), recounting sizes is O(min(n - m, m)) for a split into n - m and m items;
+  // O(n) with balancing policies other than AVL.
+  TreeMap split(const key_type &key)
+  {
+    if constexpr (!hasJoin)
+    {
+      std::vector<Node *> nodes;
+      collectNodes(root, nodes);
+
+      auto middle = std::partition_point(nodes.begin(), nodes.end(), [&](Node *n) { return less(getKey(n), key); });
+      std::vector<Node *> greater(middle, nodes.end());
+      nodes.erase(middle, nodes.end());
+
+      TreeMap result(compare);
+      result.resetNodes(greater);
+      resetNodes(nodes);
+
+      return result;
+    }
+
+    SplitResult parts = split(root, key);
+
+    if (parts.middle)
+    {
+      parts.right = join(nullptr, parts.middle, parts.right);
+    }
+
+    if constexpr (Threaded)
+    {
+      // both parts keep their in-order links, only the one between them is cut
+      if (Node *last = highestNode(parts.left))
+      {
+        last->next = nullptr;
+      }
+
+      if (Node *first = smallestNode(parts.right))
+      {
+        first->prev = nullptr;
+      }
+    }
+
+    auto [smallerSize, leftIsSmaller] = countSmaller(parts.left, parts.right);
+    size_type total = size;
+
+    TreeMap result(compare);
+    result.setRoot(parts.right, leftIsSmaller ? total - smallerSize : smallerSize);
+    setRoot(parts.left, leftIsSmaller ? smallerSize : total - smallerSize);
+
+    return result;
+  }
+
+  // Concatenates two maps in O(log n) (O(n) with policies other than AVL),
+  // all keys in left must be smaller than all keys in right.
+  static TreeMap join(TreeMap &&left, TreeMap &&right)
+  {
+    if (!left.isEmpty() && !right.isEmpty() && !left.less(left.getKey(left.pEnd), right.getKey(right.pBegin)))
+    {
+      throw std::invalid_argument("Joining maps with overlapping keys!");
+    }
+
+    TreeMap result(left.compare);
+
+    if constexpr (hasJoin)
+    {
+      if constexpr (Threaded)
+      {
+        if (left.pEnd && right.pBegin)
+        {
+          left.pEnd->next = right.pBegin;
+          right.pBegin->prev = left.pEnd;
+        }
+      }
+
+      result.setRoot(result.join2(left.root, right.root), left.size + right.size);
+    }
+    else
+    {
+      std::vector<Node *> nodes;
+      collectNodes(left.root, nodes);
+      collectNodes(right.root, nodes);
+      result.resetNodes(nodes);
+    }
+
+    left.resetRoot(nullptr, 0);
+    right.resetRoot(nullptr, 0);
+
+    return result;
+  }
+
+  // Set operations below run in O(m log(n / m + 1)) for maps of sizes m <= n with AVL balancing
+  // and in O(n + m) with other policies or threaded nodes, whose links are rebuilt. On key collision the value already stored in this map is kept.
+
+  void unionWith(const TreeMap &other)
+  {
+    if (this == &other)
+    {
+      return;
+    }
+
+    if constexpr (!hasJoin)
+    {
+      rebuild(other.root, SetOperation::unite);
+      return;
+    }
+
+    size_type matches = 0;
+    Node *newRoot = unite(root, other.root, matches);
+    resetRoot(newRoot, size + other.size - matches);
+  }
+
+  void unionWith(TreeMap &&other)
+  {
+    mergeFrom(std::move(other));
+  }
+
+  void intersectWith(const TreeMap &other)
+  {
+    if (this == &other)
+    {
+      return;
+    }
+
+    if constexpr (!hasJoin)
+    {
+      rebuild(other.root, SetOperation::intersect);
+      return;
+    }
+
+    size_type matches = 0;
+    Node *newRoot = intersect(root, other.root, matches);
+    resetRoot(newRoot, matches);
+  }
+
+  // Removes all keys present in other.
+  void difference(const TreeMap &other)
+  {
+    if (this == &other)
+    {
+      removeTree(root);
+      resetRoot(nullptr, 0);
+      return;
+    }
+
+    if constexpr (!hasJoin)
+    {
+      rebuild(other.root, SetOperation::subtract);
+      return;
+    }
+
+    size_type matches = 0;
+    Node *newRoot = subtract(root, other.root, matches);
+    resetRoot(newRoot, size - matches);
+  }
+
+  // Parallel variants, left and right subtrees are processed by the pool's threads.
+
+  void unionWith(const TreeMap &other, TaskPool &pool)
+  {
+    if (this == &other)
+    {
+      return;
+    }
+
+    if constexpr (!hasJoin)
+    {
+      rebuild(other.root, SetOperation::unite);
+      return;
+    }
+
+    size_type matches = 0;
+    Node *newRoot = unite(root, other.root, matches, pool);
+    resetRoot(newRoot, size + other.size - matches);
+  }
+
+  void intersectWith(const TreeMap &other, TaskPool &pool)
+  {
+    if (this == &other)
+    {
+      return;
+    }
+
+    if constexpr (!hasJoin)
+    {
+      rebuild(other.root, SetOperation::intersect);
+      return;
+    }
+
+    size_type matches = 0;
+    Node *newRoot = intersect(root, other.root, matches, pool);
+    resetRoot(newRoot, matches);
+  }
+
+  void clear()
+  {
+    removeTree(root);
+    resetRoot(nullptr, 0);
+  }
+
+  void clear(TaskPool &pool)
+  {
+    removeTree(root, pool);
+    resetRoot(nullptr, 0);
+  }
+
+  // Union which reuses nodes of other instead of copying them, other is left empty.
+  void mergeFrom(TreeMap &&other)
+  {
+    if (this == &other)
+    {
+      return;
+    }
+
+    if constexpr (hasJoin)
+    {
+      size_type matches = 0;
+      Node *newRoot = merge(root, other.root, matches);
+      resetRoot(newRoot, size + other.size - matches);
+    }
+    else
+    {
+      rebuild(other.root, SetOperation::merge);
+    }
+
+    other.resetRoot(nullptr, 0);
+  }
+
+  // Read-only copy in a cache-friendly layout, for data that is no longer modified.
+  FrozenTreeMap<key_type, mapped_type, Compare> freeze() const
+  {
+    std::vector<const value_type *> items;
+    items.reserve(size);
+
+    for (const auto &item : *this)
+    {
+      items.push_back(&item);
+    }
+
+    return FrozenTreeMap<key_type, mapped_type, Compare>(items.begin(), items.end(), compare);
+  }
+
+#ifndef NDEBUG
+  // For tests: throws std::logic_error naming the first broken invariant of the links, key order,
+  // size, begin and end nodes, in-order threads and Balancing's rank rules.
+  void checkInvariants() const
+  {
+    const Node *previous = nullptr;
+    int count = 0;
+
+    checkSubtree(root, nullptr, previous, count);
+
+    if (count != size)
+    {
+      throw std::logic_error("Size differs from the number of nodes");
+    }
+
+    if (pBegin != smallestNode(root) || pEnd != highestNode(root))
+    {
+      throw std::logic_error("Begin or end node is not the smallest or highest one");
+    }
+
+    if constexpr (Threaded)
+    {
+      if (previous && previous->next)
+      {
+        throw std::logic_error("Highest node has a successor thread");
+      }
+    }
+  }
+#endif
+
   bool operator==(const TreeMap &other) const
   {
     if (size != other.size)
@@ -599,8 +1897,8 @@ public:
 
 };
 
-template <typename KeyType, typename ValueType>
-class TreeMap<KeyType, ValueType>::ConstIterator
+template <typename KeyType, typename ValueType, typename Compare, typename Balancing, bool Threaded>
+class TreeMap<KeyType, ValueType, Compare, Balancing, Threaded>::ConstIterator
 {
 public:
   using reference = typename TreeMap::const_reference;
@@ -611,11 +1909,13 @@ public:
   using mapped_type = typename TreeMap::mapped_type;
 
 private:
-  const TreeMap<KeyType, ValueType> *map;
+  friend class TreeMap;
+
+  const TreeMap *map;
   Node *actualNode;
 
 public:
-  explicit ConstIterator(const TreeMap<KeyType, ValueType> *map, Node *actualNode)
+  explicit ConstIterator(const TreeMap *map, Node *actualNode)
       : map(map), actualNode(actualNode) {}
 
   ConstIterator(const ConstIterator &other)
@@ -628,30 +1928,7 @@ public:
       throw std::out_of_range("Incrementing end()");
     }
 
-    if (actualNode->rChild)
-    {
-      actualNode = actualNode->rChild;
-
-      while (actualNode->lChild)
-      {
-        actualNode = actualNode->lChild;
-      }
-      return *this;
-    }
-
-    while (actualNode->parent && actualNode != actualNode->parent->lChild)
-    {
-      actualNode = actualNode->parent;
-    }
-
-    if (actualNode->parent)
-    {
-      actualNode = actualNode->parent;
-    }
-    else
-    {
-      actualNode = nullptr;
-    }
+    actualNode = TreeMap::successor(actualNode);
 
     return *this;
   }
@@ -676,30 +1953,7 @@ public:
       return *this;
     }
 
-    if (actualNode->lChild)
-    {
-      actualNode = actualNode->lChild;
-
-      while (actualNode->rChild)
-      {
-        actualNode = actualNode->rChild;
-      }
-      return *this;
-    }
-
-    while (actualNode->parent && actualNode != actualNode->parent->rChild)
-    {
-      actualNode = actualNode->parent;
-    }
-
-    if (actualNode->parent)
-    {
-      actualNode = actualNode->parent;
-    }
-    else
-    {
-      actualNode = nullptr;
-    }
+    actualNode = TreeMap::predecessor(actualNode);
 
     return *this;
   }
@@ -737,8 +1991,8 @@ public:
   }
 };
 
-template <typename KeyType, typename ValueType>
-class TreeMap<KeyType, ValueType>::Iterator : public TreeMap<KeyType, ValueType>::ConstIterator
+template <typename KeyType, typename ValueType, typename Compare, typename Balancing, bool Threaded>
+class TreeMap<KeyType, ValueType, Compare, Balancing, Threaded>::Iterator : public TreeMap<KeyType, ValueType, Compare, Balancing, Threaded>::ConstIterator
 {
 public:
   using reference = typename TreeMap::reference;
@@ -1,6 +1,4 @@
 #!/bin/sh
 
-cd src
-g++ -std=c++17 main.cpp -o../profile
-cd ..
-./profile
\ No newline at end of file
+# builds the optimised benchmark and passes all arguments on, see ./bench_bin --help
+make bench && ./bench_bin "$@"
@@ -0,0 +1,104 @@
+#include "Allocations.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+#include <string>
+
+#include <malloc.h>
+
+namespace {
+
+std::atomic<bool> enabled{false};
+std::atomic<std::uint64_t> allocations{0};
+std::atomic<std::uint64_t> bytes{0};
+std::atomic<std::int64_t> liveBytes{0};
+
+void *allocate(std::size_t size) {
+  void *block = std::malloc(size ? size : 1);
+
+  if(!block) {
+    throw std::bad_alloc();
+  }
+
+  if(enabled.load(std::memory_order_relaxed)) {
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    bytes.fetch_add(size, std::memory_order_relaxed);
+    liveBytes.fetch_add(malloc_usable_size(block), std::memory_order_relaxed);
+  }
+
+  return block;
+}
+
+// blocks allocated before counting was enabled make live bytes drop, only differences are meaningful
+void deallocate(void *block) {
+  if(block && enabled.load(std::memory_order_relaxed)) {
+    liveBytes.fetch_sub(malloc_usable_size(block), std::memory_order_relaxed);
+  }
+
+  std::free(block);
+}
+
+} // namespace
+
+void countAllocations(bool enable) {
+  enabled.store(enable);
+}
+
+bool countingAllocations() {
+  return enabled.load();
+}
+
+AllocationCounters allocationCounters() {
+  AllocationCounters counters;
+  counters.allocations = allocations.load(std::memory_order_relaxed);
+  counters.bytes = bytes.load(std::memory_order_relaxed);
+  counters.liveBytes = liveBytes.load(std::memory_order_relaxed);
+  return counters;
+}
+
+std::size_t peakResident() {
+  std::ifstream status("/proc/self/status");
+  std::string line;
+
+  while(std::getline(status, line)) {
+    if(line.compare(0, 6, "VmHWM:") == 0) {
+      return std::stoull(line.substr(6)) * 1024;
+    }
+  }
+
+  return 0;
+}
+
+// Linux resets VmHWM to the current resident set on writing 5 to clear_refs
+void resetPeakResident() {
+  std::ofstream("/proc/self/clear_refs") << "5";
+}
+
+// Every allocation of the maps and of std::string goes through these; the nothrow forms
+// of libstdc++ call them, the aligned ones are not counted.
+
+void *operator new(std::size_t size) {
+  return allocate(size);
+}
+
+void *operator new[](std::size_t size) {
+  return allocate(size);
+}
+
+void operator delete(void *block) noexcept {
+  deallocate(block);
+}
+
+void operator delete[](void *block) noexcept {
+  deallocate(block);
+}
+
+void operator delete(void *block, std::size_t) noexcept {
+  deallocate(block);
+}
+
+void operator delete[](void *block, std::size_t) noexcept {
+  deallocate(block);
+}
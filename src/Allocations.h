@@ -0,0 +1,38 @@
+#ifndef AISDI_MAPS_ALLOCATIONS_H
+#define AISDI_MAPS_ALLOCATIONS_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Heap use of the benchmark, counted by the global operator new and delete replaced in Allocations.cpp.
+// Counting is off until enabled, as it adds two atomic updates to every allocation.
+struct AllocationCounters {
+  std::uint64_t allocations = 0;
+  std::uint64_t bytes = 0;    // as requested
+  std::int64_t liveBytes = 0; // usable size of the blocks allocated and not yet freed
+
+  AllocationCounters &operator+=(const AllocationCounters &other) {
+    allocations += other.allocations;
+    bytes += other.bytes;
+    liveBytes += other.liveBytes;
+    return *this;
+  }
+};
+
+inline AllocationCounters operator-(const AllocationCounters &after, const AllocationCounters &before) {
+  AllocationCounters difference;
+  difference.allocations = after.allocations - before.allocations;
+  difference.bytes = after.bytes - before.bytes;
+  difference.liveBytes = after.liveBytes - before.liveBytes;
+  return difference;
+}
+
+void countAllocations(bool enabled);
+bool countingAllocations();
+AllocationCounters allocationCounters();
+
+// High-water mark of the resident set in bytes since the last resetPeakResident(), 0 when unknown.
+std::size_t peakResident();
+void resetPeakResident();
+
+#endif /* AISDI_MAPS_ALLOCATIONS_H */
@@ -0,0 +1,153 @@
+#ifndef AISDI_MAPS_CLOCK_H
+#define AISDI_MAPS_CLOCK_H
+
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define AISDI_MAPS_HAS_TSC 1
+#endif
+
+// Forces value to be computed and stored, at the cost of a single memory write.
+template <typename T>
+inline void DoNotOptimize(const T &value) {
+  asm volatile("" : : "m"(value) : "memory");
+}
+
+// Forces pending writes to memory to happen, e.g. those of a map being built, before the clock is read.
+inline void ClobberMemory() {
+  asm volatile("" : : : "memory");
+}
+
+// Time stamp counter when it runs at a constant rate, clock_gettime(CLOCK_MONOTONIC) otherwise.
+// The ticks per nanosecond and the cost of a start/stop pair are calibrated once, the latter is
+// subtracted from every measured interval.
+class Clock {
+public:
+  static const Clock &instance() {
+    static const Clock clock;
+    return clock;
+  }
+
+  std::uint64_t start() const {
+#ifdef AISDI_MAPS_HAS_TSC
+    if(useTsc) {
+      // earlier instructions retire before the counter is read
+      _mm_lfence();
+      std::uint64_t ticks = __rdtsc();
+      _mm_lfence();
+      return ticks;
+    }
+#endif
+    return monotonicNanoseconds();
+  }
+
+  std::uint64_t stop() const {
+#ifdef AISDI_MAPS_HAS_TSC
+    if(useTsc) {
+      unsigned int processor;
+      std::uint64_t ticks = __rdtscp(&processor);
+      _mm_lfence();
+      return ticks;
+    }
+#endif
+    return monotonicNanoseconds();
+  }
+
+  // measured interval without the clock's own cost, never negative
+  double nanoseconds(std::uint64_t start, std::uint64_t stop) const {
+    return std::max(0.0, (stop - start) / ticksPerNanosecond - overhead);
+  }
+
+  const char *source() const {
+    return useTsc ? "tsc" : "clock_gettime";
+  }
+
+  double frequencyGHz() const {
+    return ticksPerNanosecond;
+  }
+
+  double overheadNanoseconds() const {
+    return overhead;
+  }
+
+private:
+  bool useTsc = false;
+  double ticksPerNanosecond = 1;
+  double overhead = 0;
+
+  Clock() {
+#ifdef AISDI_MAPS_HAS_TSC
+    useTsc = hasInvariantTsc();
+#endif
+
+    if(useTsc) {
+      calibrateFrequency();
+    }
+
+    calibrateOverhead();
+  }
+
+  static std::uint64_t monotonicNanoseconds() {
+    timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return static_cast<std::uint64_t>(time.tv_sec) * 1000000000u + time.tv_nsec;
+  }
+
+  // the counter neither changes rate with frequency scaling nor stops in sleep states
+  static bool hasInvariantTsc() {
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::string line;
+
+    while(std::getline(cpuinfo, line)) {
+      if(line.compare(0, 5, "flags") == 0) {
+        return line.find(" constant_tsc") != std::string::npos && line.find(" nonstop_tsc") != std::string::npos;
+      }
+    }
+
+    return false;
+  }
+
+  // median rate over a few 10 ms windows
+  void calibrateFrequency() {
+    std::vector<double> rates;
+
+    for(int i = 0; i < 5; ++i) {
+      std::uint64_t startNs = monotonicNanoseconds();
+      std::uint64_t startTicks = start();
+
+      while(monotonicNanoseconds() - startNs < 10000000) {
+      }
+
+      std::uint64_t stopTicks = stop();
+      std::uint64_t stopNs = monotonicNanoseconds();
+
+      rates.push_back(static_cast<double>(stopTicks - startTicks) / (stopNs - startNs));
+    }
+
+    std::sort(rates.begin(), rates.end());
+    ticksPerNanosecond = rates[rates.size() / 2];
+  }
+
+  // median of many empty intervals
+  void calibrateOverhead() {
+    std::vector<double> empty;
+
+    for(int i = 0; i < 1001; ++i) {
+      std::uint64_t begin = start();
+      std::uint64_t end = stop();
+      empty.push_back((end - begin) / ticksPerNanosecond);
+    }
+
+    std::sort(empty.begin(), empty.end());
+    overhead = empty[empty.size() / 2];
+  }
+};
+
+#endif /* AISDI_MAPS_CLOCK_H */
@@ -0,0 +1,553 @@
+#include "Experiments.h"
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include <malloc.h>
+
+#include "../include/HashMap.h"
+#include "../include/TreeMap.h"
+#include "../include/ConcurrentSkipListMap.h"
+#include "../include/ConcurrentTreeMap.h"
+#include "../include/CompactTreeMap.h"
+#include "../include/RadixTreeMap.h"
+
+
+namespace {
+
+void parallelScalingTest(int size) {
+  using Tree = aisdi::TreeMap<int, std::string>;
+
+  std::vector<std::pair<int, std::string>> items;
+  std::vector<std::pair<int, std::string>> otherItems;
+
+  for(int k = 0; k < size; ++k) {
+    items.emplace_back(2 * k, "test");
+    otherItems.emplace_back(3 * k, "test");
+  }
+
+  const Tree tree = Tree::fromSorted(items.begin(), items.end());
+  const Tree other = Tree::fromSorted(otherItems.begin(), otherItems.end());
+
+  unsigned maxThreads = std::max(1u, std::thread::hardware_concurrency());
+
+  for(unsigned threads = 1; ; threads = std::min(2 * threads, maxThreads)) {
+    aisdi::TaskPool pool(threads);
+
+    auto start = std::chrono::high_resolution_clock::now();
+    Tree built = Tree::fromSorted(items.begin(), items.end(), pool);
+    auto stop = std::chrono::high_resolution_clock::now();
+    auto elapsedBuild = std::chrono::duration_cast<std::chrono::milliseconds>(stop - start).count();
+
+    start = std::chrono::high_resolution_clock::now();
+    Tree copy(tree, pool);
+    stop = std::chrono::high_resolution_clock::now();
+    auto elapsedCopy = std::chrono::duration_cast<std::chrono::milliseconds>(stop - start).count();
+
+    start = std::chrono::high_resolution_clock::now();
+    copy.unionWith(other, pool);
+    stop = std::chrono::high_resolution_clock::now();
+    auto elapsedUnion = std::chrono::duration_cast<std::chrono::milliseconds>(stop - start).count();
+
+    start = std::chrono::high_resolution_clock::now();
+    built.intersectWith(other, pool);
+    stop = std::chrono::high_resolution_clock::now();
+    auto elapsedIntersection = std::chrono::duration_cast<std::chrono::milliseconds>(stop - start).count();
+
+    start = std::chrono::high_resolution_clock::now();
+    copy.clear(pool);
+    stop = std::chrono::high_resolution_clock::now();
+    auto elapsedClear = std::chrono::duration_cast<std::chrono::milliseconds>(stop - start).count();
+
+    std::cout << "Parallel TreeMap (" << size << " elements, " << threads << " threads): "
+              << "build " << elapsedBuild << " ms, copy " << elapsedCopy << " ms, union " << elapsedUnion
+              << " ms, intersection " << elapsedIntersection << " ms, destruction " << elapsedClear << " ms\n";
+
+    if(threads == maxThreads) {
+      break;
+    }
+  }
+}
+
+// lookup results are accumulated here, so the compiler cannot drop the lookups
+std::atomic<long> lookupSink{0};
+
+// 90% lookups and 10% upserts on random keys, each thread runs opsPerThread operations
+template <typename Operation>
+double measureThroughput(unsigned threads, int opsPerThread, Operation operation) {
+  std::vector<std::thread> workers;
+
+  auto start = std::chrono::high_resolution_clock::now();
+
+  for(unsigned t = 0; t < threads; ++t) {
+    workers.emplace_back([&operation, opsPerThread, t] {
+      std::mt19937 random(t);
+      long found = 0;
+
+      for(int i = 0; i < opsPerThread; ++i) {
+        unsigned draw = random();
+        found += operation(draw % 10 == 0, static_cast<int>(draw >> 4));
+      }
+
+      lookupSink += found;
+    });
+  }
+
+  for(auto &worker : workers) {
+    worker.join();
+  }
+
+  auto stop = std::chrono::high_resolution_clock::now();
+  auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count();
+
+  return static_cast<double>(threads) * opsPerThread * 1e9 / elapsed;
+}
+
+void concurrentMapScalingTest(int size, int opsPerThread) {
+  aisdi::ConcurrentSkipListMap<int, std::string> skipList;
+  aisdi::ConcurrentTreeMap<int, std::string> concurrentTree;
+  aisdi::TreeMap<int, std::string> tree;
+  std::mutex treeMutex;
+
+  for(int k = 0; k < size; ++k) {
+    skipList.upsert(k, "test");
+    concurrentTree.upsert(k, "test");
+    tree[k] = "test";
+  }
+
+  unsigned maxThreads = std::max(1u, std::thread::hardware_concurrency());
+
+  for(unsigned threads = 1; ; threads = std::min(2 * threads, maxThreads)) {
+    double skipListThroughput = measureThroughput(threads, opsPerThread, [&](bool write, int key) {
+      key %= size;
+
+      if(write) {
+        return skipList.upsert(key, "test");
+      }
+
+      return skipList.contains(key);
+    });
+
+    double concurrentTreeThroughput = measureThroughput(threads, opsPerThread, [&](bool write, int key) {
+      key %= size;
+
+      if(write) {
+        return concurrentTree.upsert(key, "test");
+      }
+
+      return concurrentTree.contains(key);
+    });
+
+    double treeThroughput = measureThroughput(threads, opsPerThread, [&](bool write, int key) {
+      key %= size;
+      std::lock_guard<std::mutex> lock(treeMutex);
+
+      if(write) {
+        tree[key] = "test";
+        return true;
+      }
+
+      return tree.find(key) != tree.end();
+    });
+
+    std::cout << "Concurrent ConcurrentSkipListMap (" << size << " elements, " << threads << " threads): "
+              << static_cast<long long>(skipListThroughput) << " ops/s\n";
+    std::cout << "Concurrent ConcurrentTreeMap (" << size << " elements, " << threads << " threads): "
+              << static_cast<long long>(concurrentTreeThroughput) << " ops/s\n";
+    std::cout << "Concurrent mutex + TreeMap (" << size << " elements, " << threads << " threads): "
+              << static_cast<long long>(treeThroughput) << " ops/s\n\n";
+
+    if(threads == maxThreads) {
+      break;
+    }
+  }
+}
+
+// bytes currently allocated from the heap, including chunks malloc placed in their own mappings
+std::size_t heapInUse() {
+  struct mallinfo2 info = mallinfo2();
+  return info.uordblks + info.hblkhd;
+}
+
+// builds the map from keys, then reports heap bytes per entry and the mean latency of random lookups
+template <typename Map>
+void measureLayout(const char *name, const std::vector<std::uint64_t> &keys, int lookups) {
+  std::size_t heapBefore = heapInUse();
+  Map map;
+
+  for(std::uint64_t key : keys) {
+    map[key] = key;
+  }
+
+  double bytesPerEntry = static_cast<double>(heapInUse() - heapBefore) / keys.size();
+
+  std::mt19937 random(1);
+  std::uint64_t sum = 0;
+
+  auto start = std::chrono::high_resolution_clock::now();
+
+  for(int i = 0; i < lookups; ++i) {
+    sum += map.valueOf(keys[random() % keys.size()]);
+  }
+
+  auto stop = std::chrono::high_resolution_clock::now();
+  auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count();
+
+  lookupSink += static_cast<long>(sum);
+
+  std::cout << name << " (" << keys.size() << " elements): " << bytesPerEntry << " bytes per entry, "
+            << elapsed / lookups << " nanoseconds per lookup\n";
+}
+
+void compactLayoutTest(int size, int lookups) {
+  std::mt19937_64 random(42);
+  std::vector<std::uint64_t> keys(size);
+
+  for(auto &key : keys) {
+    key = random();
+  }
+
+  measureLayout<aisdi::TreeMap<std::uint64_t, std::uint64_t>>("Layout TreeMap", keys, lookups);
+  measureLayout<aisdi::CompactTreeMap<std::uint64_t, std::uint64_t>>("Layout CompactTreeMap", keys, lookups);
+  measureLayout<aisdi::CompactTreeMap<std::uint64_t, std::uint64_t, true>>("Layout CompactTreeMap with parent links", keys, lookups);
+}
+
+// lookups per second of random present keys
+template <typename Map>
+double measureLookups(const Map &map, const std::vector<std::uint64_t> &keys, int lookups) {
+  std::mt19937 random(1);
+  std::uint64_t sum = 0;
+
+  auto start = std::chrono::high_resolution_clock::now();
+
+  for(int i = 0; i < lookups; ++i) {
+    sum += map.valueOf(keys[random() % keys.size()]);
+  }
+
+  auto stop = std::chrono::high_resolution_clock::now();
+  auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count();
+
+  lookupSink += static_cast<long>(sum);
+
+  return static_cast<double>(lookups) * 1e9 / elapsed;
+}
+
+void frozenLookupTest(int size, int lookups) {
+  std::mt19937_64 random(42);
+  std::vector<std::uint64_t> keys(size);
+  aisdi::TreeMap<std::uint64_t, std::uint64_t> tree;
+
+  for(auto &key : keys) {
+    key = random();
+    tree[key] = key;
+  }
+
+  auto start = std::chrono::high_resolution_clock::now();
+  const auto frozen = tree.freeze();
+  auto stop = std::chrono::high_resolution_clock::now();
+  auto elapsedFreeze = std::chrono::duration_cast<std::chrono::milliseconds>(stop - start).count();
+
+  double treeThroughput = measureLookups(tree, keys, lookups);
+  double frozenThroughput = measureLookups(frozen, keys, lookups);
+
+  std::cout << "Lookups in TreeMap (" << size << " elements): " << static_cast<long long>(treeThroughput) << " lookups/s\n";
+  std::cout << "Lookups in FrozenTreeMap (" << size << " elements): " << static_cast<long long>(frozenThroughput)
+            << " lookups/s, freeze " << elapsedFreeze << " ms\n\n";
+}
+
+// inserting increasing keys takes the append fast path, random keys descend from the root
+void appendTest(int size) {
+  std::vector<int> shuffled(size);
+
+  for(int k = 0; k < size; ++k) {
+    shuffled[k] = k;
+  }
+
+  std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937(1));
+
+  aisdi::TreeMap<int, int> appended;
+  auto start = std::chrono::high_resolution_clock::now();
+
+  for(int k = 0; k < size; ++k) {
+    appended[k] = k;
+  }
+
+  auto stop = std::chrono::high_resolution_clock::now();
+  auto elapsedAppend = std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count();
+
+  aisdi::TreeMap<int, int> hinted;
+  start = std::chrono::high_resolution_clock::now();
+
+  for(int k = 0; k < size; ++k) {
+    hinted.insertHint(hinted.end(), k, k);
+  }
+
+  stop = std::chrono::high_resolution_clock::now();
+  auto elapsedHint = std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count();
+
+  aisdi::TreeMap<int, int> random;
+  start = std::chrono::high_resolution_clock::now();
+
+  for(int key : shuffled) {
+    random[key] = key;
+  }
+
+  stop = std::chrono::high_resolution_clock::now();
+  auto elapsedRandom = std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count();
+
+  std::cout << "Appending to TreeMap (" << size << " increasing keys): " << elapsedAppend / size << " nanoseconds per insert\n";
+  std::cout << "Hinted insert into TreeMap (" << size << " increasing keys): " << elapsedHint / size << " nanoseconds per insert\n";
+  std::cout << "Inserting into TreeMap (" << size << " random keys): " << elapsedRandom / size << " nanoseconds per insert\n";
+}
+
+// keys are drawn from [0, 2 * size), so about half of the lookups and removals miss
+template <typename Map>
+long long measureMix(int size, int operations, int insertPercent, int removePercent) {
+  std::mt19937 random(7);
+  Map map;
+
+  for(int k = 0; k < size; ++k) {
+    map[random() % (2 * size)] = k;
+  }
+
+  std::vector<std::pair<int, int>> mix(operations);
+
+  for(auto &operation : mix) {
+    operation = {static_cast<int>(random() % 100), static_cast<int>(random() % (2 * size))};
+  }
+
+  long sink = 0;
+  auto start = std::chrono::high_resolution_clock::now();
+
+  for(const auto &[dice, key] : mix) {
+    if(dice < insertPercent) {
+      map[key] = dice;
+    }
+    else if(dice < insertPercent + removePercent) {
+      auto it = map.find(key);
+
+      if(it != map.end()) {
+        map.remove(it);
+      }
+    }
+    else {
+      sink += map.find(key) != map.end();
+    }
+  }
+
+  auto stop = std::chrono::high_resolution_clock::now();
+  lookupSink += sink;
+
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count() / operations;
+}
+
+template <typename Balancing>
+void measureMixes(const std::string &name, int size, int operations) {
+  using Map = aisdi::TreeMap<int, int, std::less<int>, Balancing>;
+
+  std::cout << name << " (" << size << " elements): insert-heavy " << measureMix<Map>(size, operations, 80, 10)
+            << " ns, delete-heavy " << measureMix<Map>(size, operations, 10, 80)
+            << " ns, lookup-heavy " << measureMix<Map>(size, operations, 5, 5) << " ns per operation\n";
+}
+
+// insert-heavy 80/10/10, delete-heavy 10/80/10 and lookup-heavy 5/5/90 percent inserts/removals/lookups
+void balancingMixTest(int size, int operations) {
+  measureMixes<aisdi::AvlBalancing>("AVL TreeMap", size, operations);
+  measureMixes<aisdi::WavlBalancing>("WAVL TreeMap", size, operations);
+  measureMixes<aisdi::RedBlackBalancing>("Red-black TreeMap", size, operations);
+}
+
+// inserts keys in the given order, then looks up random present keys
+template <typename Map, typename Key>
+void measureKeySet(const char *name, const char *keySet, const std::vector<Key> &keys, int lookups) {
+  std::size_t heapBefore = heapInUse();
+  Map map;
+
+  auto start = std::chrono::high_resolution_clock::now();
+
+  for(std::size_t i = 0; i < keys.size(); ++i) {
+    map[keys[i]] = i;
+  }
+
+  auto stop = std::chrono::high_resolution_clock::now();
+  auto elapsedInsert = std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count();
+  double bytesPerEntry = static_cast<double>(heapInUse() - heapBefore) / keys.size();
+
+  std::mt19937 random(1);
+  std::uint64_t sum = 0;
+
+  start = std::chrono::high_resolution_clock::now();
+
+  for(int i = 0; i < lookups; ++i) {
+    sum += map.valueOf(keys[random() % keys.size()]);
+  }
+
+  stop = std::chrono::high_resolution_clock::now();
+  auto elapsedLookup = std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count();
+
+  lookupSink += static_cast<long>(sum);
+
+  std::cout << name << " " << keySet << " (" << keys.size() << " elements): " << elapsedInsert / static_cast<long>(keys.size())
+            << " ns per insert, " << elapsedLookup / lookups << " ns per lookup, " << bytesPerEntry << " bytes per entry\n";
+}
+
+// dense keys are a shuffled 0..size-1, sparse ones random 64-bit numbers, strings look like URL paths
+void radixTest(int size, int lookups) {
+  std::mt19937_64 random(42);
+  std::vector<std::uint64_t> dense(size), sparse(size);
+  std::vector<std::string> strings(size);
+
+  for(int i = 0; i < size; ++i) {
+    dense[i] = i;
+    sparse[i] = random();
+    strings[i] = "/users/" + std::to_string(random() % 100000) + "/items/" + std::to_string(i);
+  }
+
+  std::shuffle(dense.begin(), dense.end(), random);
+
+  measureKeySet<aisdi::TreeMap<std::uint64_t, std::uint64_t>>("TreeMap", "dense", dense, lookups);
+  measureKeySet<aisdi::HashMap<std::uint64_t, std::uint64_t>>("HashMap", "dense", dense, lookups);
+  measureKeySet<aisdi::RadixTreeMap<std::uint64_t, std::uint64_t>>("RadixTreeMap", "dense", dense, lookups);
+  measureKeySet<aisdi::TreeMap<std::uint64_t, std::uint64_t>>("TreeMap", "sparse", sparse, lookups);
+  measureKeySet<aisdi::HashMap<std::uint64_t, std::uint64_t>>("HashMap", "sparse", sparse, lookups);
+  measureKeySet<aisdi::RadixTreeMap<std::uint64_t, std::uint64_t>>("RadixTreeMap", "sparse", sparse, lookups);
+
+  // HashMap hashes integer keys only
+  measureKeySet<aisdi::TreeMap<std::string, std::uint64_t>>("TreeMap", "strings", strings, lookups);
+  measureKeySet<aisdi::RadixTreeMap<std::string, std::uint64_t>>("RadixTreeMap", "strings", strings, lookups);
+}
+
+// builds a map in random key order, then times forward and backward scans and a random insert/remove churn
+template <typename Map>
+void measureIteration(const char *name, int size) {
+  std::vector<int> keys(size);
+
+  for(int i = 0; i < size; ++i) {
+    keys[i] = i;
+  }
+
+  std::shuffle(keys.begin(), keys.end(), std::mt19937(3));
+
+  Map map;
+
+  for(int key : keys) {
+    map[key] = key;
+  }
+
+  long sum = 0;
+
+  auto start = std::chrono::high_resolution_clock::now();
+
+  for(auto it = map.begin(); it != map.end(); ++it) {
+    sum += it->second;
+  }
+
+  auto stop = std::chrono::high_resolution_clock::now();
+  auto elapsedForward = std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count();
+
+  start = std::chrono::high_resolution_clock::now();
+
+  for(auto it = map.end(); it != map.begin();) {
+    --it;
+    sum += it->second;
+  }
+
+  stop = std::chrono::high_resolution_clock::now();
+  auto elapsedBackward = std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count();
+
+  start = std::chrono::high_resolution_clock::now();
+
+  for(int i = 0; i < size; ++i) {
+    map.remove(keys[i]);
+    map[keys[i]] = i;
+  }
+
+  stop = std::chrono::high_resolution_clock::now();
+  auto elapsedChurn = std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count();
+
+  lookupSink += sum;
+
+  std::cout << name << " (" << size << " elements): forward scan " << static_cast<double>(elapsedForward) / size
+            << " ns, backward scan " << static_cast<double>(elapsedBackward) / size << " ns per item, remove + insert "
+            << elapsedChurn / size << " ns\n";
+}
+
+void threadedIterationTest(int size) {
+  measureIteration<aisdi::TreeMap<int, int>>("TreeMap", size);
+  measureIteration<aisdi::TreeMap<int, int, std::less<int>, aisdi::AvlBalancing, true>>("Threaded TreeMap", size);
+}
+
+// random present keys looked up one by one with find() and in batches with findMany()
+void findManyTest(int size, int lookups) {
+  std::vector<std::pair<std::uint64_t, std::uint64_t>> items(size);
+
+  for(int i = 0; i < size; ++i) {
+    items[i] = {2 * static_cast<std::uint64_t>(i), i};
+  }
+
+  const auto tree = aisdi::TreeMap<std::uint64_t, std::uint64_t>::fromSorted(items.begin(), items.end());
+  const int batch = 4096;
+
+  std::mt19937_64 random(7);
+  std::vector<std::uint64_t> keys(lookups);
+
+  for(auto &key : keys) {
+    key = 2 * (random() % size);
+  }
+
+  std::uint64_t sum = 0;
+
+  auto start = std::chrono::high_resolution_clock::now();
+
+  for(auto key : keys) {
+    sum += tree.find(key)->second;
+  }
+
+  auto stop = std::chrono::high_resolution_clock::now();
+  auto elapsedFind = std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count();
+
+  start = std::chrono::high_resolution_clock::now();
+
+  for(int first = 0; first < lookups; first += batch) {
+    auto last = keys.begin() + std::min(first + batch, lookups);
+
+    for(const auto &it : tree.findMany(keys.begin() + first, last)) {
+      sum += it->second;
+    }
+  }
+
+  stop = std::chrono::high_resolution_clock::now();
+  auto elapsedFindMany = std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count();
+
+  lookupSink += static_cast<long>(sum);
+
+  std::cout << "TreeMap (" << size << " elements): find " << static_cast<double>(elapsedFind) / lookups << " ns, findMany "
+            << static_cast<double>(elapsedFindMany) / lookups << " ns per lookup, speedup "
+            << static_cast<double>(elapsedFind) / elapsedFindMany << "x\n";
+}
+
+} // namespace
+
+const std::vector<Experiment> &experiments() {
+  static const std::vector<Experiment> list = {
+    {"parallel", [] { parallelScalingTest(1000000); }},
+    {"concurrent", [] { concurrentMapScalingTest(100000, 200000); }},
+    {"compact", [] { compactLayoutTest(1000000, 1000000); }},
+    {"frozen", [] { frozenLookupTest(10000, 1000000); frozenLookupTest(1000000, 1000000); }},
+    {"append", [] { appendTest(1000000); }},
+    {"balancing", [] { balancingMixTest(1000000, 2000000); }},
+    {"radix", [] { radixTest(1000000, 1000000); }},
+    {"threaded", [] { threadedIterationTest(1000000); }},
+    {"findmany", [] { findManyTest(100000, 1000000); findManyTest(16000000, 1000000); }},
+  };
+
+  return list;
+}
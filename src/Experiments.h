@@ -0,0 +1,15 @@
+#ifndef AISDI_MAPS_EXPERIMENTS_H
+#define AISDI_MAPS_EXPERIMENTS_H
+
+#include <vector>
+
+// One-off measurements of individual features (parallel bulk operations, layouts, balancing policies...),
+// each prints its own report. Selected with --experiments.
+struct Experiment {
+  const char *name;
+  void (*run)();
+};
+
+const std::vector<Experiment> &experiments();
+
+#endif /* AISDI_MAPS_EXPERIMENTS_H */
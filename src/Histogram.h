@@ -0,0 +1,176 @@
+#ifndef AISDI_MAPS_HISTOGRAM_H
+#define AISDI_MAPS_HISTOGRAM_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+#include "Statistics.h"
+
+// Latencies in whole nanoseconds after HdrHistogram: values below 1024 are counted exactly, larger ones
+// in 512 linear sub-buckets per power of two, so any recorded value is known within 0.2%.
+// Recording is an index computation and an increment, cheap enough for every operation.
+class LatencyHistogram {
+public:
+  LatencyHistogram()
+      : counts(subBuckets + (64 - subBucketBits) * halfSubBuckets, 0) {}
+
+  void record(double nanoseconds) {
+    std::uint64_t value = nanoseconds > 0 ? static_cast<std::uint64_t>(nanoseconds + 0.5) : 0;
+
+    ++counts[indexOf(value)];
+    ++total;
+    lowest = std::min(lowest, value);
+    highest = std::max(highest, value);
+  }
+
+  void add(const LatencyHistogram &other) {
+    for(std::size_t i = 0; i < counts.size(); ++i) {
+      counts[i] += other.counts[i];
+    }
+
+    total += other.total;
+    lowest = std::min(lowest, other.lowest);
+    highest = std::max(highest, other.highest);
+  }
+
+  std::uint64_t count() const {
+    return total;
+  }
+
+  std::uint64_t max() const {
+    return highest;
+  }
+
+  // the highest value equivalent to the one at or below which fraction of the recordings fall
+  std::uint64_t percentile(double fraction) const {
+    std::uint64_t target = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(std::ceil(fraction * total)));
+    std::uint64_t seen = 0;
+
+    for(std::size_t i = 0; i < counts.size(); ++i) {
+      seen += counts[i];
+
+      if(seen >= target) {
+        return std::min(highestEquivalent(i), highest);
+      }
+    }
+
+    return highest;
+  }
+
+  // the summary of the recordings, MAD by the bucket values
+  Summary summary() const {
+    Summary result;
+
+    if(total == 0) {
+      return result;
+    }
+
+    result.samples = total;
+    result.median = percentile(0.5);
+    result.p90 = percentile(0.9);
+    result.p99 = percentile(0.99);
+    result.p999 = percentile(0.999);
+    result.min = lowest;
+    result.max = highest;
+
+    std::vector<std::pair<double, std::uint64_t>> deviations;
+
+    for(std::size_t i = 0; i < counts.size(); ++i) {
+      if(counts[i]) {
+        deviations.emplace_back(std::abs(static_cast<double>(highestEquivalent(i)) - result.median), counts[i]);
+      }
+    }
+
+    std::sort(deviations.begin(), deviations.end());
+    std::uint64_t seen = 0;
+
+    for(const auto &deviation : deviations) {
+      seen += deviation.second;
+
+      if(2 * seen >= total) {
+        result.mad = deviation.first;
+        break;
+      }
+    }
+
+    return result;
+  }
+
+  // The percentile distribution in the .hgrm format of HdrHistogram, which its plotter reads:
+  // five steps per halving of the distance to 100%, down to the last recording.
+  void write(std::ostream &out) const {
+    out << std::setw(12) << "Value" << std::setw(15) << "Percentile" << std::setw(11) << "TotalCount" << std::setw(18)
+        << "1/(1-Percentile)" << "\n\n"
+        << std::fixed;
+
+    for(double percent = 0;; percent += 100 / (5 * std::pow(2, std::floor(std::log2(100 / (100 - percent))) + 1))) {
+      std::uint64_t value = percentile(percent / 100);
+      bool last = value == highest || percent >= 100;
+
+      out << std::setprecision(3) << std::setw(12) << static_cast<double>(value) << std::setprecision(12)
+          << std::setw(15) << (last ? 1.0 : percent / 100) << std::setw(11) << countAtOrBelow(value);
+
+      if(last) {
+        out << "\n";
+        break;
+      }
+
+      out << std::setprecision(2) << std::setw(18) << 100 / (100 - percent) << "\n";
+    }
+
+    out << std::setprecision(3) << "#[Max     = " << std::setw(12) << static_cast<double>(highest)
+        << ", Total count    = " << std::setw(12) << total << "]\n"
+        << std::defaultfloat;
+  }
+
+private:
+  static constexpr int subBucketBits = 10;
+  static constexpr std::size_t subBuckets = std::size_t(1) << subBucketBits;
+  static constexpr std::size_t halfSubBuckets = subBuckets / 2;
+
+  std::vector<std::uint64_t> counts;
+  std::uint64_t total = 0;
+  std::uint64_t lowest = UINT64_MAX;
+  std::uint64_t highest = 0;
+
+  static std::size_t indexOf(std::uint64_t value) {
+    if(value < subBuckets) {
+      return static_cast<std::size_t>(value);
+    }
+
+    int magnitude = 63 - __builtin_clzll(value); // at least subBucketBits
+    int shift = magnitude - subBucketBits + 1;
+
+    return subBuckets + (magnitude - subBucketBits) * halfSubBuckets + ((value >> shift) - halfSubBuckets);
+  }
+
+  static std::uint64_t highestEquivalent(std::size_t index) {
+    if(index < subBuckets) {
+      return index;
+    }
+
+    std::size_t magnitude = (index - subBuckets) / halfSubBuckets + subBucketBits;
+    std::uint64_t sub = (index - subBuckets) % halfSubBuckets + halfSubBuckets;
+    int shift = static_cast<int>(magnitude) - subBucketBits + 1;
+
+    return ((sub + 1) << shift) - 1;
+  }
+
+  std::uint64_t countAtOrBelow(std::uint64_t value) const {
+    std::uint64_t seen = 0;
+
+    for(std::size_t i = 0; i <= indexOf(value); ++i) {
+      seen += counts[i];
+    }
+
+    return seen;
+  }
+};
+
+#endif /* AISDI_MAPS_HISTOGRAM_H */
@@ -0,0 +1,95 @@
+#ifndef AISDI_MAPS_MAPADAPTER_H
+#define AISDI_MAPS_MAPADAPTER_H
+
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+template <typename Map, typename = void>
+struct HasErase : std::false_type {};
+
+template <typename Map>
+struct HasErase<Map, std::void_t<decltype(std::declval<Map &>().erase(std::declval<typename Map::iterator>()))>>
+    : std::true_type {};
+
+template <typename Map, typename = void>
+struct HasClear : std::false_type {};
+
+template <typename Map>
+struct HasClear<Map, std::void_t<decltype(std::declval<Map &>().clear())>> : std::true_type {};
+
+// The operations workloads are made of, over the aisdi maps (operator[], find, remove(iterator))
+// and standard-like containers (the same with erase(iterator)), so all are measured by the same code.
+template <typename Map>
+class MapAdapter {
+public:
+  using key_type = typename Map::key_type;
+  using mapped_type = typename Map::mapped_type;
+
+  explicit MapAdapter(Map &map)
+      : map(map) {}
+
+  // address of the value, nullptr when key is missing
+  const mapped_type *read(const key_type &key) const {
+    auto it = map.find(key);
+    return it == map.end() ? nullptr : &it->second;
+  }
+
+  void write(const key_type &key, const mapped_type &value) {
+    map[key] = value;
+  }
+
+  // key must be present, saves the aisdi maps a second search
+  void removePresent(const key_type &key) {
+    if constexpr (HasErase<Map>::value) {
+      map.erase(key);
+    }
+    else {
+      map.remove(key);
+    }
+  }
+
+  bool remove(const key_type &key) {
+    auto it = map.find(key);
+
+    if(it == map.end()) {
+      return false;
+    }
+
+    if constexpr (HasErase<Map>::value) {
+      map.erase(it);
+    }
+    else {
+      map.remove(it);
+    }
+
+    return true;
+  }
+
+  // HashMap has no clear(), it is replaced by an empty map instead
+  void clear() {
+    if constexpr (HasClear<Map>::value) {
+      map.clear();
+    }
+    else {
+      map = Map();
+    }
+  }
+
+  // visits up to length items from key on in iteration order (key order for ordered maps), returns their count
+  template <typename Visitor>
+  std::size_t scan(const key_type &key, std::size_t length, Visitor visit) const {
+    std::size_t count = 0;
+
+    for(auto it = map.find(key); it != map.end() && count < length; ++it, ++count) {
+      visit(*it);
+    }
+
+    return count;
+  }
+
+private:
+  Map &map;
+};
+
+#endif /* AISDI_MAPS_MAPADAPTER_H */
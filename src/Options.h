@@ -0,0 +1,362 @@
+#ifndef AISDI_MAPS_OPTIONS_H
+#define AISDI_MAPS_OPTIONS_H
+
+#include <cstddef>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Command line of the benchmark driver, every option takes --name=value or --name value.
+struct Options {
+  std::vector<std::string> workloads = {"insert", "lookup", "remove"};
+  std::vector<std::string> maps = {"hash", "tree"};
+  std::string baseline = "std-unordered"; // map the others are compared to
+  std::vector<std::string> keys = {"int"};
+  std::vector<std::string> values = {"string"};
+  std::vector<std::size_t> sizes = {1000, 10000, 100000, 1000000};
+  std::size_t batch = 10000; // operations timed per sample
+  int repetitions = 15;
+  int warmup = 2;
+  int cpu = -1; // not pinned
+  unsigned seed = 1;
+  std::string format = "text";
+  std::string output; // standard output when empty
+  std::vector<std::string> experiments;
+  bool allocations = false; // count heap allocations, see Allocations.h
+  bool counters = false;    // read performance counters, see PerfCounters.h
+  // mixed workloads, see Ycsb.h
+  std::size_t operations = 100000;
+  std::string distribution; // the workload's own when empty
+  double theta = 0.99;
+  double hotFraction = 0.2;
+  double hotOperations = 0.8;
+  std::size_t scanLength = 100;
+  std::string mix = "read=50,update=50";
+  // per-operation latencies of the grow and mixed workloads, see Histogram.h
+  std::size_t sampleEvery = 1;
+  std::string histograms; // directory the latency distributions are written to, none when empty
+  // the concurrent workload, see Threads.h
+  std::vector<std::size_t> threads; // 1, 2, 4 ... all CPUs when empty
+  std::vector<std::string> sharing = {"shared", "sharded"};
+  std::size_t duration = 200; // milliseconds per sample
+  bool help = false;
+};
+
+// maps selectable with --maps, the third-party ones when built with them (make bench BENCH_ABSL=1)
+inline std::vector<std::string> mapNames() {
+  return {"hash", "tree", "std-unordered", "std-map",
+#ifdef AISDI_MAPS_WITH_ABSL
+          "absl-flat", "absl-btree",
+#endif
+  };
+}
+
+inline std::string mapDisplayName(const std::string &map) {
+  if(map == "hash") {
+    return "HashMap";
+  }
+
+  if(map == "tree") {
+    return "TreeMap";
+  }
+
+  if(map == "std-unordered") {
+    return "std::unordered_map";
+  }
+
+  if(map == "std-map") {
+    return "std::map";
+  }
+
+  if(map == "absl-flat") {
+    return "absl::flat_hash_map";
+  }
+
+  return map == "absl-btree" ? "absl::btree_map" : map;
+}
+
+inline const char *usage() {
+  return "Usage: bench_bin [options]\n"
+         "  --workloads=LIST    insert,lookup,remove (default), iterate, scan, copy, move, equal, clear, destroy,\n"
+         "                      grow, ycsb-a ... ycsb-f, mixed, concurrent\n"
+         "  --maps=LIST         hash, tree, std-unordered, std-map"
+#ifdef AISDI_MAPS_WITH_ABSL
+         ", absl-flat, absl-btree"
+#endif
+         " (default: hash,tree)\n"
+         "  --baseline=MAP      speeds in the text report are relative to MAP (default: std-unordered)\n"
+         "  --keys=LIST         int,u64,string,counted (default: int)\n"
+         "  --values=LIST       int,string,counted (default: string); counted ints report the comparisons,\n"
+         "                      hashes, copies, moves, assignments and destructions per operation\n"
+         "  --sizes=LIST        element counts, e.g. 1000,1e6 (default: 1000,10000,100000,1000000)\n"
+         "  --batch=N           operations timed per sample (default: 10000)\n"
+         "  --reps=N            measured samples per case (default: 15)\n"
+         "  --warmup=N          discarded samples per case (default: 2)\n"
+         "  --cpu=N             pin the benchmark to CPU N\n"
+         "  --seed=N            seed of key orders (default: 1)\n"
+         "  --format=FORMAT     text, csv or json (default: text)\n"
+         "  --output=FILE       write the report to FILE instead of standard output\n"
+         "  --experiments=LIST  run one-off experiments instead, 'all' for every one\n"
+         "  --allocations       also report allocations and bytes per operation, heap bytes per entry\n"
+         "                      and peak resident set; counting them slows allocation down a little\n"
+         "  --counters          also report cycles, instructions, L1d, LLC and dTLB misses, branch misses\n"
+         "                      and page faults per operation of the workloads timed in batches, where perf allows\n"
+         "  --help              print this message\n"
+         "Mixed workloads (ycsb-*, mixed) load size records, then run operations drawn by ratio:\n"
+         "  --operations=N      operations per sample (default: 100000)\n"
+         "  --mix=RATIOS        of the mixed workload: read, update, insert, delete, scan and rmw percentages\n"
+         "                      (default: read=50,update=50)\n"
+         "  --distribution=D    uniform, zipfian, latest or hotset (default: zipfian, latest for ycsb-d)\n"
+         "  --theta=X           zipfian skew in (0, 1) (default: 0.99)\n"
+         "  --hotset=X          fraction of records in the hot set (default: 0.2)\n"
+         "  --hot-ops=X         fraction of operations on the hot set (default: 0.8)\n"
+         "  --scan-length=N     scans visit 1..N items, those of the scan workload N (default: 100)\n"
+         "The grow workload inserts size records into an empty map. Grow and mixed workloads time single operations:\n"
+         "  --sample-every=N    time every N-th operation only, the others run untimed (default: 1)\n"
+         "  --histograms=DIR    write the latency distribution of each case to DIR as an HdrHistogram .hgrm file\n"
+         "The concurrent workload runs --mix on pinned threads for a fixed time:\n"
+         "  --threads=LIST      thread counts (default: 1, 2, 4 ... every allowed CPU)\n"
+         "  --sharing=LIST      shared (one locked map) and/or sharded (a map per thread) (default: both)\n"
+         "  --duration=MS       milliseconds per sample (default: 200)\n";
+}
+
+inline std::vector<std::string> splitList(const std::string &list) {
+  std::vector<std::string> items;
+  std::stringstream stream(list);
+  std::string item;
+
+  while(std::getline(stream, item, ',')) {
+    if(!item.empty()) {
+      items.push_back(item);
+    }
+  }
+
+  return items;
+}
+
+// accepts plain integers and the 1e6 notation
+inline std::size_t parseCount(const std::string &text) {
+  std::size_t end = 0;
+  double value = 0;
+
+  try {
+    value = std::stod(text, &end);
+  }
+  catch(const std::exception &) {
+    end = 0;
+  }
+
+  if(end != text.size() || value < 0 || value != static_cast<double>(static_cast<std::size_t>(value))) {
+    throw std::invalid_argument("Not a count: " + text);
+  }
+
+  return static_cast<std::size_t>(value);
+}
+
+inline double parseNumber(const std::string &text) {
+  std::size_t end = 0;
+  double value = 0;
+
+  try {
+    value = std::stod(text, &end);
+  }
+  catch(const std::exception &) {
+    end = 0;
+  }
+
+  if(end != text.size()) {
+    throw std::invalid_argument("Not a number: " + text);
+  }
+
+  return value;
+}
+
+inline void checkChoices(const std::string &option, const std::vector<std::string> &given,
+                         const std::vector<std::string> &allowed) {
+  for(const auto &item : given) {
+    bool found = false;
+
+    for(const auto &choice : allowed) {
+      found = found || item == choice;
+    }
+
+    if(!found) {
+      throw std::invalid_argument("Unknown value of --" + option + ": " + item);
+    }
+  }
+}
+
+inline Options parseOptions(int argc, char **argv) {
+  Options options;
+
+  for(int i = 1; i < argc; ++i) {
+    std::string argument = argv[i];
+
+    if(argument.compare(0, 2, "--") != 0) {
+      throw std::invalid_argument("Unexpected argument: " + argument);
+    }
+
+    std::string name = argument.substr(2);
+    std::string value;
+    std::size_t equals = name.find('=');
+
+    if(name == "help") {
+      options.help = true;
+      continue;
+    }
+
+    if(name == "allocations") {
+      options.allocations = true;
+      continue;
+    }
+
+    if(name == "counters") {
+      options.counters = true;
+      continue;
+    }
+
+    if(equals != std::string::npos) {
+      value = name.substr(equals + 1);
+      name.resize(equals);
+    }
+    else if(i + 1 < argc) {
+      value = argv[++i];
+    }
+    else {
+      throw std::invalid_argument("Missing value of --" + name);
+    }
+
+    if(name == "workloads") {
+      options.workloads = splitList(value);
+    }
+    else if(name == "maps") {
+      options.maps = splitList(value);
+    }
+    else if(name == "baseline") {
+      options.baseline = value;
+    }
+    else if(name == "keys") {
+      options.keys = splitList(value);
+    }
+    else if(name == "values") {
+      options.values = splitList(value);
+    }
+    else if(name == "sizes") {
+      options.sizes.clear();
+
+      for(const auto &size : splitList(value)) {
+        options.sizes.push_back(parseCount(size));
+      }
+    }
+    else if(name == "batch") {
+      options.batch = parseCount(value);
+    }
+    else if(name == "reps") {
+      options.repetitions = static_cast<int>(parseCount(value));
+    }
+    else if(name == "warmup") {
+      options.warmup = static_cast<int>(parseCount(value));
+    }
+    else if(name == "cpu") {
+      options.cpu = static_cast<int>(parseCount(value));
+    }
+    else if(name == "seed") {
+      options.seed = static_cast<unsigned>(parseCount(value));
+    }
+    else if(name == "format") {
+      options.format = value;
+    }
+    else if(name == "output") {
+      options.output = value;
+    }
+    else if(name == "experiments") {
+      options.experiments = splitList(value);
+    }
+    else if(name == "operations") {
+      options.operations = parseCount(value);
+    }
+    else if(name == "mix") {
+      options.mix = value;
+    }
+    else if(name == "distribution") {
+      options.distribution = value;
+    }
+    else if(name == "theta") {
+      options.theta = parseNumber(value);
+    }
+    else if(name == "hotset") {
+      options.hotFraction = parseNumber(value);
+    }
+    else if(name == "hot-ops") {
+      options.hotOperations = parseNumber(value);
+    }
+    else if(name == "scan-length") {
+      options.scanLength = parseCount(value);
+    }
+    else if(name == "sample-every") {
+      options.sampleEvery = parseCount(value);
+    }
+    else if(name == "histograms") {
+      options.histograms = value;
+    }
+    else if(name == "threads") {
+      options.threads.clear();
+
+      for(const auto &threads : splitList(value)) {
+        options.threads.push_back(parseCount(threads));
+      }
+    }
+    else if(name == "sharing") {
+      options.sharing = splitList(value);
+    }
+    else if(name == "duration") {
+      options.duration = parseCount(value);
+    }
+    else {
+      throw std::invalid_argument("Unknown option --" + name);
+    }
+  }
+
+  checkChoices("workloads", options.workloads,
+               {"insert", "lookup", "remove", "iterate", "scan", "copy", "move", "equal", "clear", "destroy", "grow",
+                "ycsb-a", "ycsb-b", "ycsb-c", "ycsb-d", "ycsb-e", "ycsb-f", "mixed", "concurrent"});
+  checkChoices("maps", options.maps, mapNames());
+  checkChoices("baseline", {options.baseline}, mapNames());
+  checkChoices("keys", options.keys, {"int", "u64", "string", "counted"});
+  checkChoices("values", options.values, {"int", "string", "counted"});
+  checkChoices("format", {options.format}, {"text", "csv", "json"});
+  checkChoices("sharing", options.sharing, {"shared", "sharded"});
+
+  if(options.repetitions < 1 || options.batch < 1) {
+    throw std::invalid_argument("--reps and --batch must be at least 1");
+  }
+
+  if(!options.distribution.empty()) {
+    checkChoices("distribution", {options.distribution}, {"uniform", "zipfian", "latest", "hotset"});
+  }
+
+  if(options.scanLength < 1 || options.sampleEvery < 1) {
+    throw std::invalid_argument("--scan-length and --sample-every must be at least 1");
+  }
+
+  for(std::size_t size : options.sizes) {
+    if(size < 1) {
+      throw std::invalid_argument("--sizes must be at least 1");
+    }
+  }
+
+  for(std::size_t threads : options.threads) {
+    if(threads < 1) {
+      throw std::invalid_argument("--threads must be at least 1");
+    }
+  }
+
+  if(options.duration < 1) {
+    throw std::invalid_argument("--duration must be at least 1");
+  }
+
+  return options;
+}
+
+#endif /* AISDI_MAPS_OPTIONS_H */
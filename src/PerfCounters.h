@@ -0,0 +1,115 @@
+#ifndef AISDI_MAPS_PERFCOUNTERS_H
+#define AISDI_MAPS_PERFCOUNTERS_H
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// Hardware events of the calling thread in user space, counted by perf_event_open(2) once enabled.
+// Each event is opened on its own, so the kernel can multiplex them when the PMU has fewer counters;
+// their counts are scaled by the time they ran. Events the machine or perf_event_paranoid does not
+// allow are left out, with the reason in unavailable().
+class PerfCounters {
+public:
+  static PerfCounters &instance() {
+    static PerfCounters counters;
+    return counters;
+  }
+
+  PerfCounters(const PerfCounters &) = delete;
+  PerfCounters &operator=(const PerfCounters &) = delete;
+
+  ~PerfCounters() {
+    for(const auto &event : events) {
+      close(event.fd);
+    }
+  }
+
+  void enable() {
+    if(enabled) {
+      return;
+    }
+
+    enabled = true;
+    open("cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+    open("instr", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+    open("L1d miss", PERF_TYPE_HW_CACHE, cacheMiss(PERF_COUNT_HW_CACHE_L1D));
+    open("LLC miss", PERF_TYPE_HW_CACHE, cacheMiss(PERF_COUNT_HW_CACHE_LL));
+    open("dTLB miss", PERF_TYPE_HW_CACHE, cacheMiss(PERF_COUNT_HW_CACHE_DTLB));
+    open("br miss", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES);
+    open("faults", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS);
+  }
+
+  // names of the events read() returns, in its order
+  std::vector<std::string> names() const {
+    std::vector<std::string> result;
+
+    for(const auto &event : events) {
+      result.push_back(event.name);
+    }
+
+    return result;
+  }
+
+  // events that could not be opened, with the reason
+  const std::vector<std::string> &unavailable() const {
+    return failures;
+  }
+
+  // Current counts into counts, resized to the events once; nothing when disabled.
+  void read(std::vector<double> &counts) const {
+    counts.resize(events.size());
+
+    for(std::size_t i = 0; i < events.size(); ++i) {
+      std::uint64_t values[3] = {}; // count, time enabled, time running
+
+      if(::read(events[i].fd, values, sizeof(values)) == sizeof(values) && values[2] > 0) {
+        counts[i] = static_cast<double>(values[0]) * values[1] / values[2];
+      }
+    }
+  }
+
+private:
+  struct Event {
+    std::string name;
+    int fd;
+  };
+
+  bool enabled = false;
+  std::vector<Event> events;
+  std::vector<std::string> failures;
+
+  PerfCounters() = default;
+
+  static std::uint64_t cacheMiss(std::uint64_t cache) {
+    return cache | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+  }
+
+  void open(const std::string &name, std::uint32_t type, std::uint64_t config) {
+    perf_event_attr attributes;
+    std::memset(&attributes, 0, sizeof(attributes));
+    attributes.size = sizeof(attributes);
+    attributes.type = type;
+    attributes.config = config;
+    attributes.exclude_kernel = 1;
+    attributes.exclude_hv = 1;
+    attributes.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    int fd = static_cast<int>(syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0));
+
+    if(fd < 0) {
+      failures.push_back(name + ": " + std::strerror(errno));
+      return;
+    }
+
+    events.push_back({name, fd});
+  }
+};
+
+#endif /* AISDI_MAPS_PERFCOUNTERS_H */
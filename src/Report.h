@@ -0,0 +1,230 @@
+#ifndef AISDI_MAPS_REPORT_H
+#define AISDI_MAPS_REPORT_H
+
+#include <algorithm>
+#include <cstddef>
+#include <iomanip>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "Statistics.h"
+
+// Measurements of one workload on one map type and size.
+struct Result {
+  std::string workload;
+  std::string map;
+  std::string key;
+  std::string value;
+  std::size_t size = 0;
+  Summary nsPerOp;
+  // further per-operation figures, which ones depends on the workload and options
+  std::vector<std::pair<std::string, double>> metrics;
+};
+
+// Writes results as they come, as an aligned table or a JSON array, or at the end as CSV with a header line
+// naming every metric of any result. The table is followed by the speed of every map relative to the baseline
+// map (its median / theirs).
+class Report {
+public:
+  Report(std::ostream &out, const std::string &format, const std::string &baseline = "")
+      : out(out), format(format), baseline(baseline) {}
+
+  ~Report() {
+    finish();
+  }
+
+  void add(const Result &result) {
+    if(format == "csv") {
+      results.push_back(result);
+    }
+    else if(format == "json") {
+      addJson(result);
+    }
+    else {
+      addText(result);
+      results.push_back(result);
+    }
+
+    ++count;
+    out.flush();
+  }
+
+  void finish() {
+    if(format == "json" && !finished) {
+      out << (count ? "\n]\n" : "[]\n");
+    }
+
+    if(format == "text" && !finished) {
+      addRelativeSpeeds();
+    }
+
+    if(format == "csv" && !finished) {
+      writeCsv();
+    }
+
+    finished = true;
+  }
+
+private:
+  std::ostream &out;
+  std::string format;
+  std::string baseline;
+  std::vector<Result> results; // of the text report for the relative speeds, of the CSV one to write at the end
+  std::size_t count = 0;
+  bool finished = false;
+
+  static std::string caseName(const Result &result) {
+    return result.workload + " " + result.map + "<" + result.key + ", " + result.value + ">";
+  }
+
+  static std::string rowName(const Result &result) {
+    return result.workload + " <" + result.key + ", " + result.value + "> " + std::to_string(result.size);
+  }
+
+  // One row per workload, types and size, one column per map, all relative to the baseline map, or to the
+  // first map measured when the baseline was not; "-" in rows it has no result in. Skipped when only one map was.
+  void addRelativeSpeeds() {
+    std::vector<std::string> rows;
+    std::vector<std::string> maps;
+
+    for(const auto &result : results) {
+      if(std::find(rows.begin(), rows.end(), rowName(result)) == rows.end()) {
+        rows.push_back(rowName(result));
+      }
+
+      if(std::find(maps.begin(), maps.end(), result.map) == maps.end()) {
+        maps.push_back(result.map);
+      }
+    }
+
+    if(maps.size() < 2) {
+      return;
+    }
+
+    const std::string compared = std::find(maps.begin(), maps.end(), baseline) == maps.end() ? maps.front() : baseline;
+    out << "\n" << std::left << std::setw(48) << ("speed relative to " + compared) << std::right;
+
+    for(const auto &map : maps) {
+      out << std::setw(std::max<std::size_t>(10, map.size() + 2)) << map;
+    }
+
+    out << "\n";
+
+    for(const auto &row : rows) {
+      const Result *reference = nullptr;
+
+      for(const auto &result : results) {
+        if(rowName(result) == row && result.map == compared && result.nsPerOp.median > 0) {
+          reference = &result;
+        }
+      }
+
+      out << std::left << std::setw(48) << row << std::right << std::fixed << std::setprecision(2);
+
+      for(const auto &map : maps) {
+        std::string cell = "-";
+
+        for(const auto &result : results) {
+          if(reference && rowName(result) == row && result.map == map && result.nsPerOp.median > 0) {
+            std::ostringstream speed;
+            speed << std::fixed << std::setprecision(2) << reference->nsPerOp.median / result.nsPerOp.median << "x";
+            cell = speed.str();
+          }
+        }
+
+        out << std::setw(std::max<std::size_t>(10, map.size() + 2)) << cell;
+      }
+
+      out << "\n" << std::defaultfloat;
+    }
+  }
+
+  void addText(const Result &result) {
+    if(count == 0) {
+      out << std::left << std::setw(48) << "case" << std::right << std::setw(10) << "size" << std::setw(10) << "median"
+          << std::setw(9) << "MAD" << std::setw(10) << "p90" << std::setw(10) << "p99" << std::setw(10) << "p99.9"
+          << std::setw(10) << "min" << std::setw(10) << "max" << "  (ns per operation)\n";
+    }
+
+    const Summary &s = result.nsPerOp;
+
+    out << std::left << std::setw(48) << caseName(result) << std::right << std::setw(10) << result.size << std::fixed
+        << std::setprecision(1) << std::setw(10) << s.median << std::setw(9) << s.mad << std::setw(10) << s.p90
+        << std::setw(10) << s.p99 << std::setw(10) << s.p999 << std::setw(10) << s.min << std::setw(10) << s.max;
+
+    for(const auto &metric : result.metrics) {
+      out << "  " << metric.first << " " << std::setprecision(2) << metric.second;
+    }
+
+    out << "\n" << std::defaultfloat;
+  }
+
+  // One column per metric any result has, left empty in the rows of results without it.
+  void writeCsv() {
+    std::vector<std::string> names;
+
+    for(const auto &result : results) {
+      for(const auto &metric : result.metrics) {
+        if(std::find(names.begin(), names.end(), metric.first) == names.end()) {
+          names.push_back(metric.first);
+        }
+      }
+    }
+
+    out << "workload,map,key,value,size,samples,median_ns,mad_ns,p90_ns,p99_ns,p999_ns,min_ns,max_ns";
+
+    for(const auto &name : names) {
+      out << "," << name;
+    }
+
+    out << "\n";
+
+    for(const auto &result : results) {
+      const Summary &s = result.nsPerOp;
+
+      out << result.workload << "," << result.map << "," << result.key << "," << result.value << "," << result.size
+          << "," << s.samples << "," << s.median << "," << s.mad << "," << s.p90 << "," << s.p99 << "," << s.p999 << ","
+          << s.min << "," << s.max;
+
+      for(const auto &name : names) {
+        out << ",";
+
+        for(const auto &metric : result.metrics) {
+          if(metric.first == name) {
+            out << metric.second;
+            break;
+          }
+        }
+      }
+
+      out << "\n";
+    }
+  }
+
+  void addJson(const Result &result) {
+    const Summary &s = result.nsPerOp;
+
+    out << (count ? ",\n" : "[\n") << "  {\"workload\": \"" << result.workload << "\", \"map\": \"" << result.map
+        << "\", \"key\": \"" << result.key << "\", \"value\": \"" << result.value << "\", \"size\": " << result.size
+        << ", \"samples\": " << s.samples << ", \"ns_per_op\": {\"median\": " << s.median << ", \"mad\": " << s.mad
+        << ", \"p90\": " << s.p90 << ", \"p99\": " << s.p99 << ", \"p999\": " << s.p999 << ", \"min\": " << s.min
+        << ", \"max\": " << s.max << "}";
+
+    if(!result.metrics.empty()) {
+      out << ", \"metrics\": {";
+
+      for(std::size_t i = 0; i < result.metrics.size(); ++i) {
+        out << (i ? ", " : "") << "\"" << result.metrics[i].first << "\": " << result.metrics[i].second;
+      }
+
+      out << "}";
+    }
+
+    out << "}";
+  }
+};
+
+#endif /* AISDI_MAPS_REPORT_H */
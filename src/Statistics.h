@@ -0,0 +1,58 @@
+#ifndef AISDI_MAPS_STATISTICS_H
+#define AISDI_MAPS_STATISTICS_H
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+// Robust summary of repeated measurements: the median and the median absolute deviation
+// are not dragged by the occasional interrupted sample the way the mean and deviation are.
+struct Summary {
+  std::size_t samples = 0;
+  double median = 0;
+  double mad = 0;
+  double p90 = 0;
+  double p99 = 0;
+  double p999 = 0;
+  double min = 0;
+  double max = 0;
+};
+
+// linearly interpolated between the closest ranks, sorted must not be empty
+inline double percentile(const std::vector<double> &sorted, double fraction) {
+  double position = fraction * (sorted.size() - 1);
+  std::size_t below = static_cast<std::size_t>(std::floor(position));
+  std::size_t above = std::min(below + 1, sorted.size() - 1);
+
+  return sorted[below] + (position - below) * (sorted[above] - sorted[below]);
+}
+
+inline Summary summarize(std::vector<double> samples) {
+  Summary summary;
+
+  if(samples.empty()) {
+    return summary;
+  }
+
+  std::sort(samples.begin(), samples.end());
+
+  summary.samples = samples.size();
+  summary.median = percentile(samples, 0.5);
+  summary.p90 = percentile(samples, 0.9);
+  summary.p99 = percentile(samples, 0.99);
+  summary.p999 = percentile(samples, 0.999);
+  summary.min = samples.front();
+  summary.max = samples.back();
+
+  for(auto &sample : samples) {
+    sample = std::abs(sample - summary.median);
+  }
+
+  std::sort(samples.begin(), samples.end());
+  summary.mad = percentile(samples, 0.5);
+
+  return summary;
+}
+
+#endif /* AISDI_MAPS_STATISTICS_H */
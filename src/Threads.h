@@ -0,0 +1,260 @@
+#ifndef AISDI_MAPS_THREADS_H
+#define AISDI_MAPS_THREADS_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <random>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+
+#include <pthread.h>
+#include <sched.h>
+
+#include "MapAdapter.h"
+#include "Workloads.h"
+#include "Ycsb.h"
+
+// Multi-threaded mode: pinned workers run a mixed workload for a fixed duration on
+//   shared   one map of all records behind a reader-writer lock, as none of the measured maps is thread-safe,
+//   sharded  a map per worker, without locking, holding the records r with r % threads == worker.
+// Only operations are counted, not timed, so key generation is part of the measured work.
+
+// CPUs the process may run on, workers are pinned to them in turn
+inline std::vector<int> allowedCpus() {
+  cpu_set_t set;
+  std::vector<int> cpus;
+
+  if(sched_getaffinity(0, sizeof(set), &set) == 0) {
+    for(int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+      if(CPU_ISSET(cpu, &set)) {
+        cpus.push_back(cpu);
+      }
+    }
+  }
+
+  return cpus;
+}
+
+// 1, 2, 4 ... and the number of allowed CPUs
+inline std::vector<std::size_t> defaultThreadCounts() {
+  std::size_t cpus = std::max<std::size_t>(1, allowedCpus().size());
+  std::vector<std::size_t> counts;
+
+  for(std::size_t threads = 1; threads < cpus; threads *= 2) {
+    counts.push_back(threads);
+  }
+
+  counts.push_back(cpus);
+  return counts;
+}
+
+struct ConcurrentRun {
+  std::vector<std::size_t> operations; // completed by each worker
+  double seconds = 0;
+
+  double throughput() const {
+    std::size_t total = 0;
+
+    for(std::size_t count : operations) {
+      total += count;
+    }
+
+    return seconds > 0 ? total / seconds : 0;
+  }
+
+  // Jain's index: 1 when all workers completed as many operations, 1 / threads when one did all
+  double fairness() const {
+    double sum = 0;
+    double squares = 0;
+
+    for(std::size_t count : operations) {
+      sum += count;
+      squares += static_cast<double>(count) * count;
+    }
+
+    return squares > 0 ? sum * sum / (operations.size() * squares) : 1;
+  }
+};
+
+// Starts threads workers pinned to the allowed CPUs, releases them together once all are running
+// and stops them after seconds. work(worker, stop) runs operations until stop is set and returns their count.
+template <typename Work>
+ConcurrentRun runWorkers(std::size_t threads, double seconds, Work work) {
+  const std::vector<int> cpus = allowedCpus();
+  std::atomic<std::size_t> ready{0};
+  std::atomic<bool> go{false};
+  std::atomic<bool> stop{false};
+  std::vector<std::thread> workers;
+
+  ConcurrentRun run;
+  run.operations.assign(threads, 0);
+
+  for(std::size_t worker = 0; worker < threads; ++worker) {
+    workers.emplace_back([&, worker] {
+      ready.fetch_add(1);
+
+      while(!go.load(std::memory_order_acquire)) {
+        std::this_thread::yield();
+      }
+
+      run.operations[worker] = work(worker, stop);
+    });
+
+    if(!cpus.empty()) {
+      cpu_set_t set;
+      CPU_ZERO(&set);
+      CPU_SET(cpus[worker % cpus.size()], &set);
+      pthread_setaffinity_np(workers.back().native_handle(), sizeof(set), &set);
+    }
+  }
+
+  while(ready.load() < threads) {
+    std::this_thread::yield();
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  go.store(true, std::memory_order_release);
+  std::this_thread::sleep_for(std::chrono::duration<double>(seconds));
+  stop.store(true, std::memory_order_relaxed);
+  run.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  for(auto &worker : workers) {
+    worker.join();
+  }
+
+  return run;
+}
+
+// The operations of one worker, drawn as in ycsbRun with a copy of a prepared chooser; a cache line
+// apart from those of other workers.
+class alignas(64) OperationStream {
+public:
+  OperationStream(const YcsbOptions &options, const KeyChooser &chooser, unsigned seed)
+      : random(seed), chooser(chooser), scanLengths(1, options.scanLength) {
+    const Mix &mix = options.workload.mix;
+    operations = std::discrete_distribution<int>({mix.read, mix.update, mix.insert, mix.remove, mix.scan, mix.readModifyWrite});
+  }
+
+  Operation operation() {
+    return static_cast<Operation>(operations(random));
+  }
+
+  std::size_t record(std::size_t records) {
+    return chooser.next(records, random);
+  }
+
+  std::size_t scanLength(Operation operation) {
+    return operation == Operation::scan ? scanLengths(random) : 0;
+  }
+
+private:
+  std::mt19937_64 random;
+  std::discrete_distribution<int> operations;
+  KeyChooser chooser;
+  std::uniform_int_distribution<std::size_t> scanLengths;
+};
+
+inline bool isReadOnly(Operation operation) {
+  return operation == Operation::read || operation == Operation::scan;
+}
+
+// The streams of threads workers, built before they start so that no worker computes zipfian constants
+// in the measured time; they are computed once for records and copied.
+inline std::vector<OperationStream> operationStreams(std::size_t threads, std::size_t records, const YcsbOptions &options,
+                                                     unsigned seed) {
+  KeyChooser chooser(options.workload.distribution, options.theta, options.hotFraction, options.hotOperations);
+  chooser.prepare(records);
+
+  std::vector<OperationStream> streams;
+  streams.reserve(threads);
+
+  for(std::size_t worker = 0; worker < threads; ++worker) {
+    streams.emplace_back(options, chooser, seed + static_cast<unsigned>(worker));
+  }
+
+  return streams;
+}
+
+// One map loaded with records 0..records-1, reads and scans under a shared lock, everything else exclusive.
+template <typename Map>
+ConcurrentRun sharedRun(std::size_t records, std::size_t threads, double seconds, const YcsbOptions &options,
+                        unsigned seed) {
+  using Key = typename Map::key_type;
+  using Value = typename Map::mapped_type;
+
+  Map map;
+  MapAdapter<Map> adapter(map);
+  Value value = makeItem(7, TypeTag<Value>());
+  std::shared_mutex mutex;
+  std::atomic<std::size_t> next{records}; // record the next insert adds
+
+  for(std::size_t record : shuffledRecords(records, seed)) {
+    adapter.write(makeItem(record, TypeTag<Key>()), value);
+  }
+
+  std::vector<OperationStream> streams = operationStreams(threads, records, options, seed);
+
+  return runWorkers(threads, seconds, [&](std::size_t worker, const std::atomic<bool> &stop) {
+    OperationStream &stream = streams[worker];
+    std::size_t count = 0;
+
+    for(; !stop.load(std::memory_order_relaxed); ++count) {
+      Operation operation = stream.operation();
+      std::size_t record = operation == Operation::insert ? next.fetch_add(1) : stream.record(next.load());
+      std::size_t length = stream.scanLength(operation);
+      Key key = makeItem(record, TypeTag<Key>());
+
+      if(isReadOnly(operation)) {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        applyOperation(adapter, operation, key, value, length);
+      }
+      else {
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        applyOperation(adapter, operation, key, value, length);
+      }
+    }
+
+    return count;
+  });
+}
+
+// A map per worker; its i-th record is i * threads + worker, so shards never share a key.
+template <typename Map>
+ConcurrentRun shardedRun(std::size_t records, std::size_t threads, double seconds, const YcsbOptions &options,
+                         unsigned seed) {
+  using Key = typename Map::key_type;
+  using Value = typename Map::mapped_type;
+
+  std::vector<Map> maps(threads);
+  Value value = makeItem(7, TypeTag<Value>());
+
+  for(std::size_t record : shuffledRecords(records, seed)) {
+    MapAdapter<Map>(maps[record % threads]).write(makeItem(record, TypeTag<Key>()), value);
+  }
+
+  // prepared for the smallest shard, the larger ones add a term on their first pick
+  std::vector<OperationStream> streams = operationStreams(threads, std::max<std::size_t>(1, records / threads), options, seed);
+
+  return runWorkers(threads, seconds, [&](std::size_t worker, const std::atomic<bool> &stop) {
+    OperationStream &stream = streams[worker];
+    MapAdapter<Map> adapter(maps[worker]);
+    std::size_t local = (records + threads - 1 - worker) / threads; // records in this shard
+    std::size_t count = 0;
+
+    for(; !stop.load(std::memory_order_relaxed); ++count) {
+      Operation operation = stream.operation();
+      std::size_t index = operation == Operation::insert ? local++ : stream.record(std::max<std::size_t>(1, local));
+      std::size_t length = stream.scanLength(operation);
+
+      applyOperation(adapter, operation, makeItem(index * threads + worker, TypeTag<Key>()), value, length);
+    }
+
+    return count;
+  });
+}
+
+#endif /* AISDI_MAPS_THREADS_H */
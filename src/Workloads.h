@@ -0,0 +1,394 @@
+#ifndef AISDI_MAPS_WORKLOADS_H
+#define AISDI_MAPS_WORKLOADS_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../include/Counted.h"
+
+#include "Allocations.h"
+#include "Clock.h"
+#include "Histogram.h"
+#include "MapAdapter.h"
+#include "PerfCounters.h"
+
+template <typename T>
+struct TypeTag {
+  using type = T;
+};
+
+// i-th distinct key or value of each supported type; 64-bit keys and strings are spread over their range
+inline std::uint64_t scatter(std::uint64_t i) {
+  return i * 0x9E3779B97F4A7C15ull; // odd, so distinct i give distinct results
+}
+
+inline int makeItem(std::size_t i, TypeTag<int>) {
+  return static_cast<int>(i);
+}
+
+inline std::uint64_t makeItem(std::size_t i, TypeTag<std::uint64_t>) {
+  return scatter(i);
+}
+
+inline std::string makeItem(std::size_t i, TypeTag<std::string>) {
+  return "user:" + std::to_string(scatter(i));
+}
+
+inline aisdi::Counted<int> makeItem(std::size_t i, TypeTag<aisdi::Counted<int>>) {
+  return static_cast<int>(i);
+}
+
+inline const char *typeName(TypeTag<int>) {
+  return "int";
+}
+
+inline const char *typeName(TypeTag<std::uint64_t>) {
+  return "u64";
+}
+
+inline const char *typeName(TypeTag<std::string>) {
+  return "string";
+}
+
+inline const char *typeName(TypeTag<aisdi::Counted<int>>) {
+  return "counted";
+}
+
+template <typename T>
+constexpr bool isCounted = false;
+
+template <typename T>
+constexpr bool isCounted<aisdi::Counted<T>> = true;
+
+// what Stopwatch reports per operation of Counted keys and values, in its order
+inline std::vector<std::string> costNames() {
+  return {"cmp/op", "hash/op", "copy/op", "move/op", "assign/op", "dtor/op"};
+}
+
+// size distinct keys in insertion order and, separately shuffled, the order they are looked up and removed in;
+// extra keys are absent from a filled map and inserted by the insert workload
+template <typename Key, typename Value>
+struct Dataset {
+  std::vector<Key> keys;
+  std::vector<Key> probes;
+  std::vector<Key> extra;
+  Value value;
+
+  Dataset(std::size_t size, std::size_t extraSize, unsigned seed)
+      : value(makeItem(42, TypeTag<Value>())) {
+    std::mt19937_64 random(seed);
+
+    keys.reserve(size);
+
+    for(std::size_t i = 0; i < size; ++i) {
+      keys.push_back(makeItem(i, TypeTag<Key>()));
+    }
+
+    for(std::size_t i = 0; i < extraSize; ++i) {
+      extra.push_back(makeItem(size + i, TypeTag<Key>()));
+    }
+
+    std::shuffle(keys.begin(), keys.end(), random);
+    std::shuffle(extra.begin(), extra.end(), random);
+    probes = keys;
+    std::shuffle(probes.begin(), probes.end(), random);
+  }
+};
+
+// 0..size-1 in a random order
+inline std::vector<std::size_t> shuffledRecords(std::size_t size, unsigned seed) {
+  std::vector<std::size_t> records(size);
+
+  for(std::size_t i = 0; i < size; ++i) {
+    records[i] = i;
+  }
+
+  std::shuffle(records.begin(), records.end(), std::mt19937_64(seed));
+  return records;
+}
+
+template <typename Map, typename Key, typename Value>
+void fill(Map &map, const Dataset<Key, Value> &data) {
+  MapAdapter<Map> adapter(map);
+
+  for(const auto &key : data.keys) {
+    adapter.write(key, data.value);
+  }
+}
+
+// Sums timed rounds of a sample, the allocations made in them and the performance counter events;
+// the clock and the counters are read once per round, never per operation.
+class Stopwatch {
+public:
+  template <typename Round>
+  void time(std::size_t operations, Round round) {
+    const Clock &clock = Clock::instance();
+    const PerfCounters &counters = PerfCounters::instance();
+
+    counters.read(eventsBefore);
+    AllocationCounters before = allocationCounters();
+    aisdi::OperationCounts costsBefore = aisdi::OperationCounts::current();
+
+    ClobberMemory();
+    std::uint64_t start = clock.start();
+    round();
+    ClobberMemory();
+    std::uint64_t stop = clock.stop();
+
+    elapsed += clock.nanoseconds(start, stop);
+    count += operations;
+    allocated += allocationCounters() - before;
+    addCosts(aisdi::OperationCounts::current() - costsBefore);
+    counters.read(eventsAfter);
+    events.resize(eventsAfter.size());
+
+    for(std::size_t i = 0; i < events.size(); ++i) {
+      events[i] += eventsAfter[i] - eventsBefore[i];
+    }
+  }
+
+  std::size_t operations() const {
+    return count;
+  }
+
+  double nanosecondsPerOperation() const {
+    return count ? elapsed / count : 0;
+  }
+
+  double allocationsPerOperation() const {
+    return count ? static_cast<double>(allocated.allocations) / count : 0;
+  }
+
+  double bytesPerOperation() const {
+    return count ? static_cast<double>(allocated.bytes) / count : 0;
+  }
+
+  // in the order of costNames(), zeros unless keys or values are Counted
+  std::vector<double> costsPerOperation() const {
+    double operations = count ? static_cast<double>(count) : 1;
+
+    return {costs.comparisons / operations, costs.hashes / operations,      costs.copies / operations,
+            costs.moves / operations,       costs.assignments / operations, costs.destructions / operations};
+  }
+
+  // in the order of PerfCounters::names()
+  std::vector<double> eventsPerOperation() const {
+    std::vector<double> result;
+
+    for(double total : events) {
+      result.push_back(count ? total / count : 0);
+    }
+
+    return result;
+  }
+
+private:
+  void addCosts(const aisdi::OperationCounts &round) {
+    costs.comparisons += round.comparisons;
+    costs.hashes += round.hashes;
+    costs.copies += round.copies;
+    costs.moves += round.moves;
+    costs.assignments += round.assignments;
+    costs.destructions += round.destructions;
+  }
+
+  double elapsed = 0;
+  std::size_t count = 0;
+  AllocationCounters allocated;
+  aisdi::OperationCounts costs;
+  std::vector<double> events;
+  std::vector<double> eventsBefore;
+  std::vector<double> eventsAfter;
+};
+
+// Operations timed together in one round: a fraction of the map, so it stays close to its nominal size.
+inline std::size_t roundSize(std::size_t size, std::size_t batch) {
+  return std::max<std::size_t>(1, std::min(batch, size / 8));
+}
+
+// Each workload runs rounds on an already built map until batch operations are timed and returns
+// their stopwatch. Mutating rounds are undone untimed, so the map keeps its size.
+
+template <typename Map, typename Key, typename Value>
+Stopwatch insertSample(Map &map, const Dataset<Key, Value> &data, std::size_t batch) {
+  MapAdapter<Map> adapter(map);
+  Stopwatch stopwatch;
+  std::size_t round = data.extra.size();
+
+  while(stopwatch.operations() < batch) {
+    stopwatch.time(round, [&] {
+      for(const auto &key : data.extra) {
+        adapter.write(key, data.value);
+      }
+    });
+
+    for(const auto &key : data.extra) {
+      adapter.removePresent(key);
+    }
+  }
+
+  return stopwatch;
+}
+
+template <typename Map, typename Key, typename Value>
+Stopwatch lookupSample(Map &map, const Dataset<Key, Value> &data, std::size_t batch) {
+  const MapAdapter<Map> adapter(map);
+  Stopwatch stopwatch;
+  std::size_t next = 0;
+
+  stopwatch.time(batch, [&] {
+    for(std::size_t i = 0; i < batch; ++i) {
+      DoNotOptimize(adapter.read(data.probes[next]));
+      next = (next + 1 == data.probes.size()) ? 0 : next + 1;
+    }
+  });
+
+  return stopwatch;
+}
+
+template <typename Map, typename Key, typename Value>
+Stopwatch removeSample(Map &map, const Dataset<Key, Value> &data, std::size_t batch) {
+  MapAdapter<Map> adapter(map);
+  Stopwatch stopwatch;
+  std::size_t round = roundSize(data.probes.size(), batch);
+  std::size_t next = 0;
+
+  while(stopwatch.operations() < batch) {
+    next = (next + round > data.probes.size()) ? 0 : next;
+    auto first = data.probes.begin() + next;
+
+    stopwatch.time(round, [&] {
+      for(auto it = first; it != first + round; ++it) {
+        adapter.removePresent(*it);
+      }
+    });
+
+    for(auto it = first; it != first + round; ++it) {
+      adapter.write(*it, data.value);
+    }
+
+    next += round;
+  }
+
+  return stopwatch;
+}
+
+// Whole-map workloads time one pass over a map of all keys and return the cost per item, except scan,
+// which costs per scan of length items from a present key, and move, per move assignment.
+
+template <typename Map, typename Key, typename Value>
+Stopwatch iterateSample(const Map &map, const Dataset<Key, Value> &data) {
+  Stopwatch stopwatch;
+
+  stopwatch.time(data.keys.size(), [&] {
+    for(const auto &item : map) {
+      DoNotOptimize(item.second);
+    }
+  });
+
+  return stopwatch;
+}
+
+template <typename Map, typename Key, typename Value>
+Stopwatch scanSample(Map &map, const Dataset<Key, Value> &data, std::size_t batch, std::size_t length) {
+  const MapAdapter<Map> adapter(map);
+  Stopwatch stopwatch;
+  std::size_t scans = std::max<std::size_t>(1, std::min(batch, data.probes.size()) / length);
+
+  stopwatch.time(scans, [&] {
+    for(std::size_t i = 0; i < scans; ++i) {
+      DoNotOptimize(adapter.scan(data.probes[i], length, [](const auto &item) { DoNotOptimize(item.second); }));
+    }
+  });
+
+  return stopwatch;
+}
+
+// the copy is destroyed untimed
+template <typename Map, typename Key, typename Value>
+Stopwatch copySample(const Map &map, const Dataset<Key, Value> &data) {
+  std::optional<Map> copy;
+  Stopwatch stopwatch;
+
+  stopwatch.time(data.keys.size(), [&] {
+    copy.emplace(map);
+  });
+
+  return stopwatch;
+}
+
+// moves map out and back batch times, leaving it as it was
+template <typename Map>
+Stopwatch moveSample(Map &map, std::size_t batch) {
+  Map other;
+  Stopwatch stopwatch;
+
+  stopwatch.time(2 * batch, [&] {
+    for(std::size_t i = 0; i < batch; ++i) {
+      other = std::move(map);
+      map = std::move(other);
+    }
+  });
+
+  return stopwatch;
+}
+
+template <typename Map, typename Key, typename Value>
+Stopwatch equalSample(const Map &map, const Map &copy, const Dataset<Key, Value> &data) {
+  Stopwatch stopwatch;
+
+  stopwatch.time(data.keys.size(), [&] {
+    DoNotOptimize(map == copy);
+  });
+
+  return stopwatch;
+}
+
+// a map filled untimed, then emptied with clear() or destroyed
+template <typename Map, typename Key, typename Value>
+Stopwatch clearSample(const Dataset<Key, Value> &data, bool destroy) {
+  std::optional<Map> map;
+  Stopwatch stopwatch;
+
+  map.emplace();
+  fill(*map, data);
+
+  stopwatch.time(data.keys.size(), [&] {
+    if(destroy) {
+      map.reset();
+    }
+    else {
+      MapAdapter<Map>(*map).clear();
+    }
+  });
+
+  return stopwatch;
+}
+
+// Inserts the keys into map, meant to be empty, timing every sampleEvery-th insert on its own into latencies,
+// so the inserts that resize or rebalance show in the tail.
+template <typename Map, typename Key, typename Value>
+void growSample(Map &map, const Dataset<Key, Value> &data, std::size_t sampleEvery, LatencyHistogram &latencies) {
+  const Clock &clock = Clock::instance();
+  MapAdapter<Map> adapter(map);
+
+  for(std::size_t i = 0; i < data.keys.size(); ++i) {
+    if(i % sampleEvery != 0) {
+      adapter.write(data.keys[i], data.value);
+      continue;
+    }
+
+    std::uint64_t start = clock.start();
+    adapter.write(data.keys[i], data.value);
+    std::uint64_t stop = clock.stop();
+
+    latencies.record(clock.nanoseconds(start, stop));
+  }
+}
+
+#endif /* AISDI_MAPS_WORKLOADS_H */
@@ -0,0 +1,349 @@
+#ifndef AISDI_MAPS_YCSB_H
+#define AISDI_MAPS_YCSB_H
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "Allocations.h"
+#include "Clock.h"
+#include "Histogram.h"
+#include "MapAdapter.h"
+#include "Options.h"
+#include "Workloads.h"
+
+// Mixed workloads after the Yahoo! Cloud Serving Benchmark: a map is loaded with records 0..size-1,
+// then operations are drawn by their ratios and pick records from a key distribution.
+
+enum class Operation { read, update, insert, remove, scan, readModifyWrite };
+
+// percentages of operations, need not add up to 100
+struct Mix {
+  double read = 0;
+  double update = 0;
+  double insert = 0;
+  double remove = 0;
+  double scan = 0;
+  double readModifyWrite = 0;
+};
+
+struct YcsbWorkload {
+  Mix mix;
+  std::string distribution;
+};
+
+// "read=50,update=30,insert=10,delete=5,scan=5,rmw=0", zipfian unless chosen otherwise
+inline YcsbWorkload parseMix(const std::string &ratios) {
+  YcsbWorkload workload;
+  workload.distribution = "zipfian";
+
+  for(const auto &ratio : splitList(ratios)) {
+    std::size_t equals = ratio.find('=');
+    std::string name = ratio.substr(0, equals);
+    double value = equals == std::string::npos ? -1 : parseNumber(ratio.substr(equals + 1));
+
+    if(value < 0) {
+      throw std::invalid_argument("Not a ratio: " + ratio);
+    }
+
+    if(name == "read") {
+      workload.mix.read = value;
+    }
+    else if(name == "update") {
+      workload.mix.update = value;
+    }
+    else if(name == "insert") {
+      workload.mix.insert = value;
+    }
+    else if(name == "delete") {
+      workload.mix.remove = value;
+    }
+    else if(name == "scan") {
+      workload.mix.scan = value;
+    }
+    else if(name == "rmw") {
+      workload.mix.readModifyWrite = value;
+    }
+    else {
+      throw std::invalid_argument("Unknown operation in --mix: " + name);
+    }
+  }
+
+  const Mix &mix = workload.mix;
+
+  if(mix.read + mix.update + mix.insert + mix.remove + mix.scan + mix.readModifyWrite <= 0) {
+    throw std::invalid_argument("--mix has no operations");
+  }
+
+  return workload;
+}
+
+// core workloads A-F as ycsb-a ... ycsb-f
+inline YcsbWorkload ycsbPreset(const std::string &name) {
+  YcsbWorkload workload;
+  workload.distribution = "zipfian";
+
+  if(name == "ycsb-a") {
+    workload.mix.read = 50; // update heavy, a session store
+    workload.mix.update = 50;
+  }
+  else if(name == "ycsb-b") {
+    workload.mix.read = 95; // read mostly, photo tagging
+    workload.mix.update = 5;
+  }
+  else if(name == "ycsb-c") {
+    workload.mix.read = 100; // read only, a profile cache
+  }
+  else if(name == "ycsb-d") {
+    workload.mix.read = 95; // read latest, status updates
+    workload.mix.insert = 5;
+    workload.distribution = "latest";
+  }
+  else if(name == "ycsb-e") {
+    workload.mix.scan = 95; // short ranges, threaded conversations
+    workload.mix.insert = 5;
+  }
+  else if(name == "ycsb-f") {
+    workload.mix.read = 50; // read-modify-write, user databases
+    workload.mix.readModifyWrite = 50;
+  }
+  else {
+    throw std::invalid_argument("Unknown YCSB workload: " + name);
+  }
+
+  return workload;
+}
+
+// Zipfian ranks 0..n-1 by Gray et al., "Quickly generating billion-record synthetic databases",
+// rank 0 being the most popular; n may grow between draws, as records are inserted.
+class ZipfianGenerator {
+public:
+  explicit ZipfianGenerator(double theta)
+      : theta(theta), alpha(1 / (1 - theta)), zeta2(1 + std::pow(0.5, theta)) {
+    if(!(theta > 0 && theta < 1)) {
+      throw std::invalid_argument("Zipfian theta must be in (0, 1)");
+    }
+  }
+
+  // computes zeta(n) ahead of the first draw from n items, which costs n powers
+  void prepare(std::size_t n) {
+    if(n != items) {
+      grow(n);
+    }
+  }
+
+  template <typename Random>
+  std::size_t next(std::size_t n, Random &random) {
+    prepare(n);
+
+    double u = std::uniform_real_distribution<double>(0, 1)(random);
+    double uz = u * zetaN;
+
+    if(uz < 1) {
+      return 0;
+    }
+
+    if(uz < zeta2) {
+      return std::min<std::size_t>(1, n - 1);
+    }
+
+    return std::min(n - 1, static_cast<std::size_t>(n * std::pow(eta * u - eta + 1, alpha)));
+  }
+
+private:
+  double theta;
+  double alpha;
+  double zeta2;
+  double zetaN = 0;
+  double eta = 0;
+  std::size_t items = 0;
+
+  // zeta(n) = sum of 1 / i^theta for i = 1..n, extended incrementally
+  void grow(std::size_t n) {
+    if(n < items) {
+      items = 0;
+      zetaN = 0;
+    }
+
+    for(std::size_t i = items + 1; i <= n; ++i) {
+      zetaN += 1 / std::pow(static_cast<double>(i), theta);
+    }
+
+    items = n;
+    eta = (1 - std::pow(2.0 / n, 1 - theta)) / (1 - zeta2 / zetaN);
+  }
+};
+
+// Picks records 0..records-1:
+//   uniform  every record equally,
+//   zipfian  by popularity, the popular records scattered over the key space,
+//   latest   by recency, the newest record being the most popular,
+//   hotset   hotOperations of the picks among the first hotFraction of records.
+class KeyChooser {
+public:
+  KeyChooser(const std::string &distribution, double theta, double hotFraction, double hotOperations)
+      : distribution(distribution), zipfian(theta), hotFraction(hotFraction), hotOperations(hotOperations) {
+    if(distribution != "uniform" && distribution != "zipfian" && distribution != "latest" && distribution != "hotset") {
+      throw std::invalid_argument("Unknown key distribution: " + distribution);
+    }
+  }
+
+  // readies the chooser to pick among records without the setup cost on the first pick
+  void prepare(std::size_t records) {
+    if(distribution == "zipfian" || distribution == "latest") {
+      zipfian.prepare(records);
+    }
+  }
+
+  template <typename Random>
+  std::size_t next(std::size_t records, Random &random) {
+    if(distribution == "zipfian") {
+      return scatter(zipfian.next(records, random)) % records;
+    }
+
+    if(distribution == "latest") {
+      return records - 1 - zipfian.next(records, random);
+    }
+
+    if(distribution == "hotset") {
+      std::size_t hot = std::max<std::size_t>(1, static_cast<std::size_t>(records * hotFraction));
+      bool inHotSet = hot == records || std::uniform_real_distribution<double>(0, 1)(random) < hotOperations;
+
+      return inHotSet ? uniform(0, hot, random) : uniform(hot, records, random);
+    }
+
+    return uniform(0, records, random);
+  }
+
+private:
+  std::string distribution;
+  ZipfianGenerator zipfian;
+  double hotFraction;
+  double hotOperations;
+
+  template <typename Random>
+  static std::size_t uniform(std::size_t first, std::size_t last, Random &random) {
+    return std::uniform_int_distribution<std::size_t>(first, last - 1)(random);
+  }
+};
+
+struct YcsbOptions {
+  YcsbWorkload workload;
+  std::size_t operations = 100000;
+  double theta = 0.99;
+  double hotFraction = 0.2;
+  double hotOperations = 0.8;
+  std::size_t scanLength = 100; // scans visit 1..scanLength items
+  std::size_t sampleEvery = 1;  // every sampleEvery-th operation is timed
+};
+
+// the workload named on the command line with its options, throws when they are out of range
+inline YcsbOptions ycsbOptions(const Options &options, const std::string &name) {
+  YcsbOptions result;
+  result.workload = (name == "mixed") ? parseMix(options.mix) : ycsbPreset(name);
+  result.operations = options.operations;
+  result.theta = options.theta;
+  result.hotFraction = options.hotFraction;
+  result.hotOperations = options.hotOperations;
+  result.scanLength = options.scanLength;
+  result.sampleEvery = options.sampleEvery;
+
+  if(!options.distribution.empty()) {
+    result.workload.distribution = options.distribution;
+  }
+
+  if(!(options.theta > 0 && options.theta < 1)) {
+    throw std::invalid_argument("--theta must be in (0, 1)");
+  }
+
+  if(!(options.hotFraction > 0 && options.hotFraction <= 1 && options.hotOperations >= 0 && options.hotOperations <= 1)) {
+    throw std::invalid_argument("--hotset must be in (0, 1] and --hot-ops in [0, 1]");
+  }
+
+  return result;
+}
+
+// One operation through adapter; length is the number of items a scan visits.
+template <typename Map>
+void applyOperation(MapAdapter<Map> &adapter, Operation operation, const typename Map::key_type &key,
+                    const typename Map::mapped_type &value, std::size_t length) {
+  switch(operation) {
+  case Operation::read:
+    DoNotOptimize(adapter.read(key));
+    break;
+  case Operation::update:
+  case Operation::insert:
+    adapter.write(key, value);
+    break;
+  case Operation::remove:
+    DoNotOptimize(adapter.remove(key));
+    break;
+  case Operation::scan:
+    DoNotOptimize(adapter.scan(key, length, [](const auto &item) { DoNotOptimize(item.second); }));
+    break;
+  case Operation::readModifyWrite:
+    if(const auto *old = adapter.read(key)) {
+      DoNotOptimize(*old);
+      adapter.write(key, value);
+    }
+    break;
+  }
+}
+
+// Latencies of the timed operations of one run in nanoseconds.
+struct YcsbRun {
+  LatencyHistogram latencies;
+  double nanoseconds = 0;       // sum of the latencies
+  AllocationCounters allocated; // by the timed operations
+};
+
+// Runs the operations on map, already loaded with records 0..records-1; the next record to insert is records.
+// Keys and values are prepared before the clock starts, only the map operation itself is timed;
+// with sampleEvery above 1 the other operations run untimed.
+template <typename Map>
+YcsbRun ycsbRun(Map &map, std::size_t records, const YcsbOptions &options, unsigned seed) {
+  using Key = typename Map::key_type;
+  using Value = typename Map::mapped_type;
+
+  const Mix &mix = options.workload.mix;
+  const Clock &clock = Clock::instance();
+
+  std::mt19937_64 random(seed);
+  std::discrete_distribution<int> operations({mix.read, mix.update, mix.insert, mix.remove, mix.scan, mix.readModifyWrite});
+  std::uniform_int_distribution<std::size_t> scanLength(1, options.scanLength);
+  KeyChooser chooser(options.workload.distribution, options.theta, options.hotFraction, options.hotOperations);
+  MapAdapter<Map> adapter(map);
+  Value value = makeItem(7, TypeTag<Value>());
+
+  YcsbRun run;
+
+  for(std::size_t i = 0; i < options.operations; ++i) {
+    auto operation = static_cast<Operation>(operations(random));
+    Key key = makeItem(operation == Operation::insert ? records : chooser.next(records, random), TypeTag<Key>());
+    std::size_t length = operation == Operation::scan ? scanLength(random) : 0;
+    records += operation == Operation::insert;
+
+    if(i % options.sampleEvery != 0) {
+      applyOperation(adapter, operation, key, value, length);
+      continue;
+    }
+
+    AllocationCounters before = allocationCounters();
+    std::uint64_t start = clock.start();
+    applyOperation(adapter, operation, key, value, length);
+    std::uint64_t stop = clock.stop();
+    double latency = clock.nanoseconds(start, stop);
+
+    run.allocated += allocationCounters() - before;
+    run.latencies.record(latency);
+    run.nanoseconds += latency;
+  }
+
+  return run;
+}
+
+#endif /* AISDI_MAPS_YCSB_H */
@@ -1,206 +1,461 @@
+#include <cctype>
+#include <fstream>
 #include <iostream>
+#include <map>
+#include <memory>
+#include <stdexcept>
 #include <string>
-#include <chrono>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include <sched.h>
 
 #include "../include/HashMap.h"
 #include "../include/TreeMap.h"
 
+#ifdef AISDI_MAPS_WITH_ABSL
+#include <absl/container/btree_map.h>
+#include <absl/container/flat_hash_map.h>
+#endif
+
+#include "Allocations.h"
+#include "Clock.h"
+#include "Experiments.h"
+#include "Histogram.h"
+#include "Options.h"
+#include "PerfCounters.h"
+#include "Report.h"
+#include "Statistics.h"
+#include "Threads.h"
+#include "Workloads.h"
+#include "Ycsb.h"
+
+
+// medians of the allocations made per timed operation, the heap bytes a filled map holds per entry
+// and the peak resident set since the workload started
+void addMemoryMetrics(Result &result, double allocations, double bytes, double liveBytesPerEntry) {
+  result.metrics.emplace_back("allocs/op", allocations);
+  result.metrics.emplace_back("bytes/op", bytes);
+  result.metrics.emplace_back("live B/entry", liveBytesPerEntry);
+  result.metrics.emplace_back("peak RSS MB", peakResident() / 1e6);
+}
 
-void addToMapTest(int size1, int size2, int size3, int size4, int size5, int size6, int size7, int size8);
-void deleteFromMapTest(int size1, int size2, int size3, int size4, int size5, int size6, int size7, int size8);
-void valueOfTest(int size1, int size2, int size3, int size4, int size5, int size6, int size7, int size8);
+template <typename Map, typename Key, typename Value>
+double liveBytesPerEntry(const Dataset<Key, Value> &data) {
+  AllocationCounters before = allocationCounters();
+  Map map;
+  fill(map, data);
 
+  return static_cast<double>((allocationCounters() - before).liveBytes) / data.keys.size();
+}
 
-int main() {
-  addToMapTest(10, 100, 250, 500, 750, 1000, 2500, 5000);
+// Summarises latencies into result with the further tail percentiles and, with --histograms, writes them
+// to DIR/workload-map-key-value-size.hgrm.
+void addLatencies(const Options &options, Result &result, const LatencyHistogram &latencies) {
+  result.nsPerOp = latencies.summary();
+  result.metrics.emplace_back("p99.99", latencies.percentile(0.9999));
+  result.metrics.emplace_back("p99.999", latencies.percentile(0.99999));
 
-  std::cout << "\n";
+  if(options.histograms.empty()) {
+    return;
+  }
 
-  deleteFromMapTest(10, 100, 250, 500, 750, 1000, 2500, 5000);
+  std::string name = result.workload + "-" + result.map + "-" + result.key + "-" + result.value + "-" +
+                     std::to_string(result.size);
 
-  std::cout << "\n";
+  for(char &c : name) {
+    c = std::isalnum(static_cast<unsigned char>(c)) || c == '-' || c == '.' ? c : '_';
+  }
 
-  valueOfTest(10, 100, 250, 500, 750, 1000, 2500, 5000);
+  std::ofstream file(options.histograms + "/" + name + ".hgrm");
 
-  return 0;
+  if(!file) {
+    throw std::runtime_error("Cannot write to " + options.histograms);
+  }
+
+  latencies.write(file);
 }
 
+// Every sample inserts the records into an empty map, pooling the latencies of the timed inserts.
+template <typename Map, typename Key, typename Value>
+void measureGrow(const Options &options, const Dataset<Key, Value> &data, Result &result) {
+  LatencyHistogram latencies;
 
-void addToMapTest(int size1, int size2, int size3, int size4, int size5, int size6, int size7, int size8) {
-  int size;
+  for(int i = -options.warmup; i < options.repetitions; ++i) {
+    LatencyHistogram sample;
+    Map map;
+    growSample(map, data, options.sampleEvery, sample);
 
-  for(int i = 0; i < 8; ++i) {
-    if(i == 0) {
-      size = size1;
-    }
-    else if(i == 1) {
-      size = size2;
-    }
-    else if(i == 2) {
-      size = size3;
+    if(i >= 0) {
+      latencies.add(sample);
     }
-    else if(i == 3) {
-      size = size4;
-    }
-    else if(i == 4) {
-      size = size5;
+  }
+
+  addLatencies(options, result, latencies);
+}
+
+// warmup samples are discarded, the remaining ones summarised; countCosts adds the operations
+// on Counted keys and values
+template <typename Sample>
+void measure(const Options &options, Result &result, double liveBytesPerEntry, bool countCosts, Sample sample) {
+  std::vector<double> nanoseconds;
+  std::vector<double> allocations;
+  std::vector<double> bytes;
+  std::vector<std::vector<double>> events(PerfCounters::instance().names().size());
+  std::vector<std::vector<double>> costs(costNames().size());
+
+  for(int i = 0; i < options.warmup; ++i) {
+    sample();
+  }
+
+  for(int i = 0; i < options.repetitions; ++i) {
+    Stopwatch stopwatch = sample();
+    nanoseconds.push_back(stopwatch.nanosecondsPerOperation());
+    allocations.push_back(stopwatch.allocationsPerOperation());
+    bytes.push_back(stopwatch.bytesPerOperation());
+
+    std::vector<double> perOperation = stopwatch.eventsPerOperation();
+
+    for(std::size_t event = 0; event < perOperation.size(); ++event) {
+      events[event].push_back(perOperation[event]);
     }
-    else if(i == 5) {
-      size = size6;
+
+    perOperation = stopwatch.costsPerOperation();
+
+    for(std::size_t cost = 0; cost < perOperation.size(); ++cost) {
+      costs[cost].push_back(perOperation[cost]);
     }
-    else if(i == 6) {
-      size = size7;
+  }
+
+  result.nsPerOp = summarize(nanoseconds);
+
+  for(std::size_t event = 0; event < events.size(); ++event) {
+    result.metrics.emplace_back(PerfCounters::instance().names()[event] + "/op", summarize(events[event]).median);
+  }
+
+  for(std::size_t cost = 0; countCosts && cost < costs.size(); ++cost) {
+    result.metrics.emplace_back(costNames()[cost], summarize(costs[cost]).median);
+  }
+
+  if(options.allocations) {
+    addMemoryMetrics(result, summarize(allocations).median, summarize(bytes).median, liveBytesPerEntry);
+  }
+}
+
+bool isMixed(const std::string &workload) {
+  return workload == "mixed" || workload.compare(0, 5, "ycsb-") == 0;
+}
+
+// Every sample loads a fresh map and runs the operations, timing each one or every --sample-every-th.
+// Reports the latency of the timed operations of all samples and the median throughput of a sample.
+template <typename Map, typename Key, typename Value>
+void measureMixed(const Options &options, const Dataset<Key, Value> &data, double liveBytesPerEntry, Result &result) {
+  YcsbOptions ycsb = ycsbOptions(options, result.workload);
+  LatencyHistogram latencies;
+  std::vector<double> throughputs;
+  std::vector<double> allocations;
+  std::vector<double> bytes;
+
+  for(int i = -options.warmup; i < options.repetitions; ++i) {
+    Map map;
+    fill(map, data);
+
+    YcsbRun run = ycsbRun(map, data.keys.size(), ycsb, options.seed + i);
+
+    if(i >= 0) {
+      double timed = static_cast<double>(run.latencies.count());
+
+      latencies.add(run.latencies);
+      throughputs.push_back(timed * 1e9 / run.nanoseconds);
+      allocations.push_back(run.allocated.allocations / timed);
+      bytes.push_back(run.allocated.bytes / timed);
     }
-    else {
-      size = size8;
+  }
+
+  result.workload += "/" + ycsb.workload.distribution;
+  result.metrics.emplace_back("ops/s", summarize(throughputs).median);
+  addLatencies(options, result, latencies);
+
+  if(options.allocations) {
+    addMemoryMetrics(result, summarize(allocations).median, summarize(bytes).median, liveBytesPerEntry);
+  }
+}
+
+// Every sample loads fresh maps and runs the --mix on each thread count for --duration. Reports the time
+// a thread spends per operation, the median aggregate throughput, the fairness among the threads and the
+// scaling efficiency: throughput per thread relative to that of the first thread count.
+template <typename Map>
+void measureConcurrent(const Options &options, const Result &base, Report &report) {
+  YcsbOptions ycsb = ycsbOptions(options, "mixed");
+  std::vector<std::size_t> counts = options.threads.empty() ? defaultThreadCounts() : options.threads;
+  double seconds = options.duration / 1000.0;
+
+  for(const auto &sharing : options.sharing) {
+    double firstPerThread = 0;
+
+    for(std::size_t threads : counts) {
+      std::vector<double> nsPerOp;
+      std::vector<double> throughputs;
+      std::vector<double> fairness;
+
+      for(int i = -options.warmup; i < options.repetitions; ++i) {
+        unsigned seed = options.seed + i;
+        ConcurrentRun run = sharing == "shared" ? sharedRun<Map>(base.size, threads, seconds, ycsb, seed)
+                                                : shardedRun<Map>(base.size, threads, seconds, ycsb, seed);
+
+        if(i >= 0) {
+          nsPerOp.push_back(threads * 1e9 / run.throughput());
+          throughputs.push_back(run.throughput());
+          fairness.push_back(run.fairness());
+        }
+      }
+
+      Result result = base;
+      double throughput = summarize(throughputs).median;
+      firstPerThread = firstPerThread ? firstPerThread : throughput / threads;
+
+      result.workload = sharing + "/" + std::to_string(threads) + "t/" + ycsb.workload.distribution;
+      result.nsPerOp = summarize(nsPerOp);
+      result.metrics.emplace_back("ops/s", throughput);
+      result.metrics.emplace_back("fairness", summarize(fairness).median);
+      result.metrics.emplace_back("efficiency", throughput / threads / firstPerThread);
+      report.add(result);
     }
+  }
+}
 
-    std::chrono::nanoseconds::rep elapsedHash = 0;
-    std::chrono::nanoseconds::rep elapsedTree = 0;
+// mutating workloads get a freshly built map per sample, lookups share one per case
+template <typename Map, typename Key, typename Value>
+void runWorkloads(const Options &options, Report &report, const std::string &mapName) {
+  for(std::size_t size : options.sizes) {
+    Dataset<Key, Value> data(size, roundSize(size, options.batch), options.seed);
+    double liveBytes = options.allocations ? liveBytesPerEntry<Map>(data) : 0;
+    bool countCosts = isCounted<Key> || isCounted<Value>;
+    std::unique_ptr<Map> filled;
+    std::unique_ptr<Map> copy;
+
+    // shared by the workloads that leave the map as it was
+    auto filledMap = [&]() -> Map & {
+      if(!filled) {
+        filled = std::make_unique<Map>();
+        fill(*filled, data);
+      }
+
+      return *filled;
+    };
+
+    for(const auto &workload : options.workloads) {
+      Result result;
+      result.workload = workload;
+      result.map = mapName;
+      result.key = typeName(TypeTag<Key>());
+      result.value = typeName(TypeTag<Value>());
+      result.size = size;
 
-    for(int j = 0; j < 1000; ++j) {
-      aisdi::HashMap<int, std::string> hash;
-      aisdi::TreeMap<int, std::string> tree;
+      if(workload == "concurrent") {
+        measureConcurrent<Map>(options, result, report);
+        continue;
+      }
+
+      resetPeakResident();
 
-      for(int k = 0; k < size - 1; ++k) {
-        hash[k] = "test";
-        tree[k] = "test";
+      if(isMixed(workload)) {
+        measureMixed<Map>(options, data, liveBytes, result);
+      }
+      else if(workload == "grow") {
+        measureGrow<Map>(options, data, result);
       }
+      else if(workload == "lookup") {
+        measure(options, result, liveBytes, countCosts, [&] { return lookupSample(filledMap(), data, options.batch); });
+      }
+      else if(workload == "iterate") {
+        measure(options, result, liveBytes, countCosts, [&] { return iterateSample(filledMap(), data); });
+      }
+      else if(workload == "scan") {
+        measure(options, result, liveBytes, countCosts,
+                [&] { return scanSample(filledMap(), data, options.batch, options.scanLength); });
+      }
+      else if(workload == "copy") {
+        measure(options, result, liveBytes, countCosts, [&] { return copySample(filledMap(), data); });
+      }
+      else if(workload == "move") {
+        measure(options, result, liveBytes, countCosts, [&] { return moveSample(filledMap(), options.batch); });
+      }
+      else if(workload == "equal") {
+        if(!copy) {
+          copy = std::make_unique<Map>(filledMap());
+        }
 
-      auto testStartHash = std::chrono::high_resolution_clock::now();
-      hash[size] = "test";
-      auto testStopHash = std::chrono::high_resolution_clock::now();
+        measure(options, result, liveBytes, countCosts, [&] { return equalSample(filledMap(), *copy, data); });
+      }
+      else if(workload == "clear" || workload == "destroy") {
+        measure(options, result, liveBytes, countCosts,
+                [&] { return clearSample<Map>(data, workload == "destroy"); });
+      }
+      else {
+        measure(options, result, liveBytes, countCosts, [&] {
+          Map map;
+          fill(map, data);
 
-      auto testStartTree = std::chrono::high_resolution_clock::now();
-      tree[size] = "test";
-      auto testStopTree = std::chrono::high_resolution_clock::now();
+          return workload == "insert" ? insertSample(map, data, options.batch) : removeSample(map, data, options.batch);
+        });
+      }
 
-      elapsedHash += std::chrono::duration_cast<std::chrono::nanoseconds>(testStopHash - testStartHash).count();
-      elapsedTree += std::chrono::duration_cast<std::chrono::nanoseconds>(testStopTree - testStartTree).count();
+      report.add(result);
     }
-
-    std::cout << "Adding to HashMap (" << size << "th. element): " << elapsedHash / 1000 << " nanoseconds\n";
-    std::cout << "Adding to TreeMap (" << size << "th. element): " << elapsedTree / 1000 << " nanoseconds\n\n";
   }
 }
 
-void deleteFromMapTest(int size1, int size2, int size3, int size4, int size5, int size6, int size7, int size8) {
-  int size;
+template <typename Key, typename Value>
+void runMaps(const Options &options, Report &report) {
+  for(const auto &map : options.maps) {
+    std::string name = mapDisplayName(map);
 
-  for(int i = 0; i < 8; ++i) {
-    if(i == 0) {
-      size = size1;
+    if(map == "tree") {
+      runWorkloads<aisdi::TreeMap<Key, Value>, Key, Value>(options, report, name);
+    }
+    else if(map == "std-map") {
+      runWorkloads<std::map<Key, Value>, Key, Value>(options, report, name);
     }
-    else if(i == 1) {
-      size = size2;
+    else if(map == "std-unordered") {
+      runWorkloads<std::unordered_map<Key, Value>, Key, Value>(options, report, name);
     }
-    else if(i == 2) {
-      size = size3;
+#ifdef AISDI_MAPS_WITH_ABSL
+    else if(map == "absl-flat") {
+      runWorkloads<absl::flat_hash_map<Key, Value>, Key, Value>(options, report, name);
     }
-    else if(i == 3) {
-      size = size4;
+    else if(map == "absl-btree") {
+      runWorkloads<absl::btree_map<Key, Value>, Key, Value>(options, report, name);
     }
-    else if(i == 4) {
-      size = size5;
+#endif
+    else if constexpr (std::is_integral_v<Key> || std::is_same_v<Key, aisdi::Counted<int>>) {
+      runWorkloads<aisdi::HashMap<Key, Value>, Key, Value>(options, report, name);
     }
-    else if(i == 5) {
-      size = size6;
+    else {
+      std::cerr << "Skipping HashMap<" << typeName(TypeTag<Key>()) << ", ...>, it hashes integral keys only\n";
+    }
+  }
+}
+
+template <typename Key>
+void runValues(const Options &options, Report &report) {
+  for(const auto &value : options.values) {
+    if(value == "int") {
+      runMaps<Key, int>(options, report);
     }
-    else if(i == 6) {
-      size = size7;
+    else if(value == "counted") {
+      runMaps<Key, aisdi::Counted<int>>(options, report);
     }
     else {
-      size = size8;
+      runMaps<Key, std::string>(options, report);
     }
+  }
+}
 
-    std::chrono::nanoseconds::rep elapsedHash = 0;
-    std::chrono::nanoseconds::rep elapsedTree = 0;
+void runBenchmarks(const Options &options, Report &report) {
+  for(const auto &key : options.keys) {
+    if(key == "int") {
+      runValues<int>(options, report);
+    }
+    else if(key == "u64") {
+      runValues<std::uint64_t>(options, report);
+    }
+    else if(key == "counted") {
+      runValues<aisdi::Counted<int>>(options, report);
+    }
+    else {
+      runValues<std::string>(options, report);
+    }
+  }
+}
 
-    for(int j = 0; j < 1000; ++j) {
-      aisdi::HashMap<int, std::string> hash;
-      aisdi::TreeMap<int, std::string> tree;
+void runExperiments(const std::vector<std::string> &names) {
+  for(const auto &name : names) {
+    bool found = false;
 
-      for(int k = 0; k < size - 1; ++k) {
-        hash[k] = "test";
-        tree[k] = "test";
+    for(const auto &experiment : experiments()) {
+      if(name == "all" || name == experiment.name) {
+        experiment.run();
+        std::cout << "\n";
+        found = true;
       }
+    }
 
-      auto itHash = hash.begin();
-      auto itTree = tree.begin();
-
-      auto testStartHash = std::chrono::high_resolution_clock::now();
-      hash.remove(itHash);
-      auto testStopHash = std::chrono::high_resolution_clock::now();
-
-      auto testStartTree = std::chrono::high_resolution_clock::now();
-      tree.remove(itTree);
-      auto testStopTree = std::chrono::high_resolution_clock::now();
-
-      elapsedHash += std::chrono::duration_cast<std::chrono::nanoseconds>(testStopHash - testStartHash).count();
-      elapsedTree += std::chrono::duration_cast<std::chrono::nanoseconds>(testStopTree - testStartTree).count();
+    if(!found) {
+      throw std::invalid_argument("Unknown experiment: " + name);
     }
+  }
+}
 
-    std::cout << "Deleting from HashMap (" << size << "th. element): " << elapsedHash / 1000 << " nanoseconds\n";
-    std::cout << "Deleting from TreeMap (" << size << "th. element): " << elapsedTree / 1000 << " nanoseconds\n\n";
+void pinToCpu(int cpu) {
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+
+  if(sched_setaffinity(0, sizeof(set), &set) != 0) {
+    throw std::runtime_error("Cannot pin to CPU " + std::to_string(cpu));
   }
 }
 
-void valueOfTest(int size1, int size2, int size3, int size4, int size5, int size6, int size7, int size8) {
-  int size;
+int main(int argc, char **argv) {
+  try {
+    Options options = parseOptions(argc, argv);
 
-  for(int i = 0; i < 8; ++i) {
-    if(i == 0) {
-      size = size1;
-    }
-    else if(i == 1) {
-      size = size2;
-    }
-    else if(i == 2) {
-      size = size3;
+    if(options.help) {
+      std::cout << usage();
+      return 0;
     }
-    else if(i == 3) {
-      size = size4;
-    }
-    else if(i == 4) {
-      size = size5;
-    }
-    else if(i == 5) {
-      size = size6;
-    }
-    else if(i == 6) {
-      size = size7;
-    }
-    else {
-      size = size8;
+
+    if(options.cpu >= 0) {
+      pinToCpu(options.cpu);
     }
 
-    std::chrono::nanoseconds::rep elapsedHash = 0;
-    std::chrono::nanoseconds::rep elapsedTree = 0;
+    countAllocations(options.allocations);
 
-    for(int j = 0; j < 1000; ++j) {
-      aisdi::HashMap<int, std::string> hash;
-      aisdi::TreeMap<int, std::string> tree;
+    if(options.counters) {
+      PerfCounters &counters = PerfCounters::instance();
+      counters.enable();
 
-      for(int k = 0; k < size - 1; ++k) {
-        hash[k] = "test";
-        tree[k] = "test";
+      for(std::size_t i = 0; i < counters.unavailable().size(); ++i) {
+        std::cerr << (i ? "; " : "Performance counters unavailable: ") << counters.unavailable()[i];
       }
 
-      int halfSize = size / 2;
+      std::cerr << (counters.unavailable().empty() ? "" : "\n");
+    }
+
+    for(const auto &workload : options.workloads) {
+      if(isMixed(workload) || workload == "concurrent") {
+        ycsbOptions(options, isMixed(workload) ? workload : "mixed");
+      }
+    }
+
+    if(!options.experiments.empty()) {
+      runExperiments(options.experiments);
+      return 0;
+    }
 
-      auto testStartHash = std::chrono::high_resolution_clock::now();
-      hash.valueOf(halfSize);
-      auto testStopHash = std::chrono::high_resolution_clock::now();
+    std::ofstream file;
 
-      auto testStartTree = std::chrono::high_resolution_clock::now();
-      tree.valueOf(halfSize);
-      auto testStopTree = std::chrono::high_resolution_clock::now();
+    if(!options.output.empty()) {
+      file.open(options.output);
 
-      elapsedHash += std::chrono::duration_cast<std::chrono::nanoseconds>(testStopHash - testStartHash).count();
-      elapsedTree += std::chrono::duration_cast<std::chrono::nanoseconds>(testStopTree - testStartTree).count();
+      if(!file) {
+        throw std::runtime_error("Cannot write " + options.output);
+      }
     }
 
-    std::cout << "Value Of element in HashMap (" << size << "th. element): " << elapsedHash / 1000 << " nanoseconds\n";
-    std::cout << "Value Of element in TreeMap (" << size << "th. element): " << elapsedTree / 1000 << " nanoseconds\n\n";
+    const Clock &clock = Clock::instance();
+    std::cerr << "Clock: " << clock.source() << " at " << clock.frequencyGHz() << " ticks/ns, "
+              << clock.overheadNanoseconds() << " ns overhead subtracted per timed batch\n";
+
+    Report report(options.output.empty() ? std::cout : file, options.format, mapDisplayName(options.baseline));
+    runBenchmarks(options, report);
+  }
+  catch(const std::exception &error) {
+    std::cerr << error.what() << "\n\n" << usage();
+    return 1;
   }
-}
\ No newline at end of file
+
+  return 0;
+}
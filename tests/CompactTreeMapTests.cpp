@@ -0,0 +1,216 @@
+#include "../include/CompactTreeMap.h"
+
+#include <cstdint>
+#include <map>
+#include <random>
+#include <string>
+#include <utility>
+
+#include <boost/test/unit_test.hpp>
+
+#include <boost/mpl/list.hpp>
+
+using TestedMaps = boost::mpl::list<aisdi::CompactTreeMap<std::int32_t, std::string>,
+                                    aisdi::CompactTreeMap<std::uint64_t, std::string>,
+                                    aisdi::CompactTreeMap<std::int32_t, std::string, true>>;
+
+BOOST_AUTO_TEST_SUITE(CompactTreeMapTests)
+
+template <typename Map>
+void thenMapIteratesInOrder(const Map& map,
+                            const std::map<typename Map::key_type, std::string>& expected)
+{
+  BOOST_CHECK_EQUAL(map.getSize(), expected.size());
+
+  auto expectedIt = expected.begin();
+
+  for (auto it = map.begin(); it != map.end(); ++it, ++expectedIt)
+  {
+    BOOST_REQUIRE(expectedIt != expected.end());
+    BOOST_CHECK_EQUAL(it->first, expectedIt->first);
+    BOOST_CHECK_EQUAL(it->second, expectedIt->second);
+  }
+
+  BOOST_CHECK(expectedIt == expected.end());
+
+  auto expectedReverseIt = expected.rbegin();
+
+  for (auto it = map.end(); expectedReverseIt != expected.rend(); ++expectedReverseIt)
+  {
+    --it;
+    BOOST_CHECK_EQUAL(it->first, expectedReverseIt->first);
+  }
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenMap_WhenCreatedWithDefaultConstructor_ThenItIsEmpty,
+                              Map,
+                              TestedMaps)
+{
+  const Map map;
+
+  BOOST_CHECK(map.isEmpty());
+  BOOST_CHECK(map.begin() == map.end());
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenMap_WhenAddingItems_ThenTheyAreIteratedInOrder,
+                              Map,
+                              TestedMaps)
+{
+  Map map = { { 42, "Alice" }, { 27, "Bob" } };
+  map[13] = "Chuck";
+  map[42] = "Dave";
+
+  thenMapIteratesInOrder(map, { { 13, "Chuck" }, { 27, "Bob" }, { 42, "Dave" } });
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenMap_WhenRemovingItems_ThenRemainingItemsAreIntact,
+                              Map,
+                              TestedMaps)
+{
+  Map map = { { 1, "a" }, { 2, "b" }, { 3, "c" }, { 4, "d" }, { 5, "e" } };
+
+  map.remove(2);
+  map.remove(map.find(4));
+
+  thenMapIteratesInOrder(map, { { 1, "a" }, { 3, "c" }, { 5, "e" } });
+  BOOST_CHECK_EQUAL(map.valueOf(5), "e");
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenMap_WhenAccessingMissingKey_ThenExceptionIsThrown,
+                              Map,
+                              TestedMaps)
+{
+  Map map = { { 42, "Alice" } };
+  const Map& constMap = map;
+
+  BOOST_CHECK_THROW(map.remove(27), std::out_of_range);
+  BOOST_CHECK_THROW(map.valueOf(27), std::out_of_range);
+  BOOST_CHECK_THROW(constMap.valueOf(27), std::out_of_range);
+  BOOST_CHECK(map.find(27) == map.end());
+  BOOST_CHECK_EQUAL(map.getSize(), 1u);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenBeginAndEndIterators_WhenMovingPastThem_ThenOperationThrows,
+                              Map,
+                              TestedMaps)
+{
+  const Map empty;
+  const Map map = { { 1, "a" } };
+
+  BOOST_CHECK_THROW(++empty.end(), std::out_of_range);
+  BOOST_CHECK_THROW(--empty.end(), std::out_of_range);
+  BOOST_CHECK_THROW(--map.begin(), std::out_of_range);
+  BOOST_CHECK_THROW(*map.end(), std::out_of_range);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenMap_WhenCopyingAndMoving_ThenContentsFollow,
+                              Map,
+                              TestedMaps)
+{
+  Map map = { { 1, "a" }, { 2, "b" } };
+
+  Map copy = map;
+  copy[3] = "c";
+
+  BOOST_CHECK(copy != map);
+  BOOST_CHECK_EQUAL(map.getSize(), 2u);
+
+  Map moved = std::move(copy);
+
+  BOOST_CHECK(copy.isEmpty());
+  thenMapIteratesInOrder(moved, { { 1, "a" }, { 2, "b" }, { 3, "c" } });
+
+  moved.remove(3);
+
+  BOOST_CHECK(moved == map);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenMap_WhenShrinkingArena_ThenNoSlackIsLeft,
+                              Map,
+                              TestedMaps)
+{
+  Map map;
+  map.reserve(100);
+
+  for (int i = 0; i < 10; ++i)
+  {
+    map[i] = "x";
+  }
+
+  const auto reserved = map.getArenaBytes();
+  map.shrinkToFit();
+
+  BOOST_CHECK_EQUAL(map.getArenaBytes() * 10, reserved);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenReservedArena_WhenInsertingWithinIt_ThenReferencesStayValid,
+                              Map,
+                              TestedMaps)
+{
+  Map map;
+  map.reserve(100);
+
+  std::string& first = map[0];
+  first = "first";
+
+  for (int i = 1; i < 100; ++i)
+  {
+    map[i] = "x";
+  }
+
+  BOOST_CHECK_EQUAL(&first, &map.valueOf(0));
+  BOOST_CHECK_EQUAL(first, "first");
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenIterator_WhenInsertingPastArenaCapacity_ThenItStillPointsToItsEntry,
+                              Map,
+                              TestedMaps)
+{
+  Map map;
+  map[50] = "fifty";
+
+  const auto it = map.find(50);
+
+  for (int i = 0; i < 100; ++i)
+  {
+    map[i * 2 + 1] = "x";
+  }
+
+  BOOST_CHECK_EQUAL(it->first, typename Map::key_type(50));
+  BOOST_CHECK_EQUAL(it->second, "fifty");
+  BOOST_CHECK(it == map.find(50));
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenRandomOperations_WhenComparedToModel_ThenMapMatches,
+                              Map,
+                              TestedMaps)
+{
+  std::mt19937 random(11);
+  Map map;
+  std::map<typename Map::key_type, std::string> model;
+
+  for (int i = 0; i < 20000; ++i)
+  {
+    typename Map::key_type key = random() % 500;
+
+    if (model.count(key) && random() % 2)
+    {
+      map.remove(key);
+      model.erase(key);
+    }
+    else
+    {
+      map[key] = std::to_string(i);
+      model[key] = std::to_string(i);
+    }
+
+    if (i % 997 == 0)
+    {
+      thenMapIteratesInOrder(map, model);
+    }
+  }
+
+  thenMapIteratesInOrder(map, model);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,214 @@
+#include "../include/ConcurrentSkipListMap.h"
+
+#include <atomic>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+using Map = aisdi::ConcurrentSkipListMap<int, std::string>;
+
+BOOST_AUTO_TEST_SUITE(ConcurrentSkipListMapTests)
+
+BOOST_AUTO_TEST_CASE(GivenMap_WhenCreatedWithDefaultConstructor_ThenItIsEmpty)
+{
+  const Map map;
+
+  BOOST_CHECK(map.isEmpty());
+  BOOST_CHECK(map.begin() == map.end());
+}
+
+BOOST_AUTO_TEST_CASE(GivenMap_WhenUpserting_ThenNewKeysAreInsertedAndExistingUpdated)
+{
+  Map map;
+
+  BOOST_CHECK(map.upsert(42, "Alice"));
+  BOOST_CHECK(map.upsert(27, "Bob"));
+  BOOST_CHECK(!map.upsert(42, "Chuck"));
+
+  BOOST_CHECK_EQUAL(map.getSize(), 2u);
+  BOOST_CHECK_EQUAL(map.valueOf(42), "Chuck");
+  BOOST_CHECK_EQUAL(map.valueOf(27), "Bob");
+  BOOST_CHECK_THROW(map.valueOf(13), std::out_of_range);
+}
+
+BOOST_AUTO_TEST_CASE(GivenMap_WhenRemoving_ThenKeyIsGone)
+{
+  Map map = { { 42, "Alice" }, { 27, "Bob" } };
+
+  map.remove(42);
+
+  BOOST_CHECK(!map.contains(42));
+  BOOST_CHECK(map.find(42) == map.end());
+  BOOST_CHECK_EQUAL(map.getSize(), 1u);
+  BOOST_CHECK_THROW(map.remove(42), std::out_of_range);
+
+  map.remove(map.begin());
+
+  BOOST_CHECK(map.isEmpty());
+}
+
+BOOST_AUTO_TEST_CASE(GivenMap_WhenIterating_ThenItemsAreInOrder)
+{
+  Map map;
+  std::map<int, std::string> expected;
+
+  for (int i = 0; i < 500; ++i)
+  {
+    map.upsert(i * 37 % 499, std::to_string(i));
+    expected[i * 37 % 499] = std::to_string(i);
+  }
+
+  auto expectedIt = expected.begin();
+
+  for (const auto &item : map)
+  {
+    BOOST_REQUIRE(expectedIt != expected.end());
+    BOOST_CHECK_EQUAL(item.first, expectedIt->first);
+    BOOST_CHECK_EQUAL(item.second, expectedIt->second);
+    ++expectedIt;
+  }
+
+  BOOST_CHECK(expectedIt == expected.end());
+}
+
+BOOST_AUTO_TEST_CASE(GivenMap_WhenScanningRange_ThenOnlyKeysInRangeAreVisited)
+{
+  Map map;
+
+  for (int i = 0; i < 100; i += 2)
+  {
+    map.upsert(i, "x");
+  }
+
+  std::vector<int> visited;
+  map.scan(11, 21, [&](int key, const std::string &) { visited.push_back(key); });
+
+  BOOST_CHECK((visited == std::vector<int>{ 12, 14, 16, 18, 20 }));
+  BOOST_CHECK_EQUAL(map.lowerBound(13)->first, 14);
+  BOOST_CHECK(map.lowerBound(99) == map.end());
+}
+
+BOOST_AUTO_TEST_CASE(GivenManyMapsComingAndGoing_WhenAlternatingBetweenThem_ThenEachKeepsItsOwnItems)
+{
+  Map kept;
+
+  for (int round = 0; round < 1000; ++round)
+  {
+    Map map;
+
+    for (int i = 0; i < 10; ++i)
+    {
+      map.upsert(i, std::to_string(round));
+      kept.upsert(round * 10 + i, std::to_string(i));
+      map.remove(i);
+    }
+
+    BOOST_REQUIRE(map.isEmpty());
+  }
+
+  BOOST_CHECK_EQUAL(kept.getSize(), 10000u);
+  BOOST_CHECK_EQUAL(kept.valueOf(9999), "9");
+}
+
+BOOST_AUTO_TEST_CASE(GivenManyThreads_WhenInsertingDisjointKeys_ThenAllKeysArePresent)
+{
+  Map map;
+  std::vector<std::thread> threads;
+
+  for (int t = 0; t < 4; ++t)
+  {
+    threads.emplace_back([&map, t] {
+      for (int i = t; i < 20000; i += 4)
+      {
+        map.upsert(i, std::to_string(i));
+      }
+    });
+  }
+
+  for (auto &thread : threads)
+  {
+    thread.join();
+  }
+
+  BOOST_CHECK_EQUAL(map.getSize(), 20000u);
+
+  int expected = 0;
+
+  for (const auto &item : map)
+  {
+    BOOST_REQUIRE_EQUAL(item.first, expected);
+    BOOST_REQUIRE_EQUAL(item.second, std::to_string(expected));
+    ++expected;
+  }
+}
+
+BOOST_AUTO_TEST_CASE(GivenConcurrentInsertsAndRemovals_WhenIterating_ThenKeysStayOrderedAndFinalStateMatches)
+{
+  Map map;
+  std::atomic<bool> finished{false};
+  std::atomic<int> unorderedScans{0};
+  std::vector<std::thread> threads;
+
+  for (int t = 0; t < 3; ++t)
+  {
+    threads.emplace_back([&map, t] {
+      // each thread owns keys congruent to t, so its final state is known
+      for (int round = 0; round < 20; ++round)
+      {
+        for (int i = t; i < 3000; i += 3)
+        {
+          map.upsert(i, std::to_string(round));
+        }
+
+        for (int i = t; i < 3000; i += 6)
+        {
+          map.remove(i);
+        }
+      }
+    });
+  }
+
+  std::thread reader([&] {
+    while (!finished.load())
+    {
+      int previous = -1;
+
+      for (const auto &item : map)
+      {
+        if (item.first <= previous)
+        {
+          ++unorderedScans;
+        }
+
+        previous = item.first;
+      }
+    }
+  });
+
+  for (auto &thread : threads)
+  {
+    thread.join();
+  }
+
+  finished = true;
+  reader.join();
+
+  BOOST_CHECK_EQUAL(unorderedScans.load(), 0);
+
+  std::size_t expectedSize = 0;
+
+  for (int i = 0; i < 3000; ++i)
+  {
+    bool removed = (i % 3 == i % 6);
+    BOOST_CHECK_EQUAL(map.contains(i), !removed);
+    expectedSize += removed ? 0 : 1;
+  }
+
+  BOOST_CHECK_EQUAL(map.getSize(), expectedSize);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,308 @@
+#include "../include/ConcurrentTreeMap.h"
+
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+using Map = aisdi::ConcurrentTreeMap<int, long>;
+
+namespace
+{
+
+std::map<int, long> contentsOf(Map& map)
+{
+  std::map<int, long> contents;
+  int previous = -1;
+  bool ordered = true;
+
+  map.forEach([&](int key, long value) {
+    ordered = ordered && key > previous;
+    previous = key;
+    contents[key] = value;
+  });
+
+  BOOST_CHECK(ordered);
+
+  return contents;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(ConcurrentTreeMapTests)
+
+BOOST_AUTO_TEST_CASE(GivenMap_WhenCreatedWithDefaultConstructor_ThenItIsEmpty)
+{
+  const Map map;
+
+  BOOST_CHECK(map.isEmpty());
+  BOOST_CHECK(!map.contains(1));
+  BOOST_CHECK(!map.find(1));
+}
+
+BOOST_AUTO_TEST_CASE(GivenMap_WhenUpserting_ThenNewKeysAreInsertedAndExistingUpdated)
+{
+  Map map;
+
+  BOOST_CHECK(map.upsert(42, 1));
+  BOOST_CHECK(map.upsert(27, 2));
+  BOOST_CHECK(!map.upsert(42, 3));
+
+  BOOST_CHECK_EQUAL(map.getSize(), 2u);
+  BOOST_CHECK_EQUAL(map.valueOf(42), 3);
+  BOOST_CHECK_EQUAL(map.valueOf(27), 2);
+  BOOST_CHECK_THROW(map.valueOf(13), std::out_of_range);
+}
+
+BOOST_AUTO_TEST_CASE(GivenMap_WhenRemoving_ThenKeyIsGoneAndOthersStay)
+{
+  Map map = { { 50, 0 }, { 25, 1 }, { 75, 2 }, { 10, 3 }, { 30, 4 } };
+
+  map.remove(25); // has two children, leaves a routing node
+
+  BOOST_CHECK(!map.contains(25));
+  BOOST_CHECK_THROW(map.remove(25), std::out_of_range);
+  BOOST_CHECK((contentsOf(map) == std::map<int, long>{ { 10, 3 }, { 30, 4 }, { 50, 0 }, { 75, 2 } }));
+
+  map.upsert(25, 5);
+
+  BOOST_CHECK_EQUAL(map.valueOf(25), 5);
+  BOOST_CHECK_EQUAL(map.getSize(), 5u);
+}
+
+BOOST_AUTO_TEST_CASE(GivenRandomOperations_WhenComparedToSequentialModel_ThenContentsMatch)
+{
+  Map map;
+  std::map<int, long> model;
+  std::mt19937 random(11);
+
+  for (int i = 0; i < 20000; ++i)
+  {
+    int key = random() % 500;
+
+    if (model.count(key) && random() % 2)
+    {
+      map.remove(key);
+      model.erase(key);
+    }
+    else
+    {
+      map.upsert(key, i);
+      model[key] = i;
+    }
+  }
+
+  BOOST_CHECK_NO_THROW(map.checkInvariants());
+  BOOST_CHECK(contentsOf(map) == model);
+  BOOST_CHECK_EQUAL(map.getSize(), model.size());
+}
+
+// Writers own disjoint keys and write increasing values, so a linearizable map must show every
+// reader non-decreasing values per key, and must never lose keys which are present all the time.
+BOOST_AUTO_TEST_CASE(GivenConcurrentReadersAndWriters_WhenStressed_ThenReadsAreLinearizable)
+{
+  constexpr int writers = 4;
+  constexpr int readers = 3;
+  constexpr int keys = 512;
+
+  Map map;
+
+  for (int key = 0; key < keys; key += 2)
+  {
+    map.upsert(key, 0); // even keys are never removed
+  }
+
+  std::atomic<bool> finished{false};
+  std::atomic<int> violations{0};
+  std::vector<std::map<int, long>> models(writers);
+  std::vector<std::thread> threads;
+
+  for (int w = 0; w < writers; ++w)
+  {
+    threads.emplace_back([&, w] {
+      std::mt19937 random(w);
+
+      for (long step = 1; step <= 20000; ++step)
+      {
+        int key = (random() % (keys / writers)) * writers + w;
+
+        if (key % 2 == 1 && models[w].count(key) && random() % 2)
+        {
+          map.remove(key);
+          models[w].erase(key);
+        }
+        else
+        {
+          map.upsert(key, step);
+          models[w][key] = step;
+        }
+      }
+    });
+  }
+
+  for (int r = 0; r < readers; ++r)
+  {
+    threads.emplace_back([&, r] {
+      std::mt19937 random(100 + r);
+      std::vector<long> lastSeen(keys, 0);
+
+      while (!finished.load())
+      {
+        int key = random() % keys;
+        auto value = map.find(key);
+
+        if (key % 2 == 0 && !value)
+        {
+          ++violations;
+        }
+
+        if (value && key % 2 == 0)
+        {
+          if (*value < lastSeen[key])
+          {
+            ++violations;
+          }
+
+          lastSeen[key] = *value;
+        }
+      }
+    });
+  }
+
+  for (int w = 0; w < writers; ++w)
+  {
+    threads[w].join();
+  }
+
+  finished = true;
+
+  for (int r = 0; r < readers; ++r)
+  {
+    threads[writers + r].join();
+  }
+
+  std::map<int, long> expected;
+
+  for (int key = 0; key < keys; key += 2)
+  {
+    expected[key] = 0;
+  }
+
+  for (const auto &model : models)
+  {
+    for (const auto &[key, value] : model)
+    {
+      expected[key] = value;
+    }
+  }
+
+  BOOST_CHECK_EQUAL(violations.load(), 0);
+  BOOST_CHECK_NO_THROW(map.checkInvariants());
+  BOOST_CHECK(contentsOf(map) == expected);
+  BOOST_CHECK_EQUAL(map.getSize(), expected.size());
+}
+
+// Writers race on the same keys: each key must be added by exactly one upsert, and once the removals
+// of one phase are done the keys left must be exactly those nobody removed.
+BOOST_AUTO_TEST_CASE(GivenWritersOnSameKeys_WhenUpsertingAndRemovingConcurrently_ThenNoUpdateIsLost)
+{
+  constexpr int writers = 4;
+  constexpr int keys = 4000;
+
+  Map map;
+  std::atomic<int> added{0};
+  std::atomic<int> replaced{0};
+
+  auto runWriters = [](auto work) {
+    std::vector<std::thread> threads;
+
+    for (int w = 0; w < writers; ++w)
+    {
+      threads.emplace_back(work, w);
+    }
+
+    for (auto &thread : threads)
+    {
+      thread.join();
+    }
+  };
+
+  runWriters([&](int w) {
+    std::vector<int> order(keys);
+    std::iota(order.begin(), order.end(), 0);
+    std::shuffle(order.begin(), order.end(), std::mt19937(w));
+
+    for (int key : order)
+    {
+      added += map.upsert(key, w);
+    }
+  });
+
+  BOOST_CHECK_EQUAL(added.load(), keys);
+  BOOST_CHECK_NO_THROW(map.checkInvariants());
+  BOOST_CHECK_EQUAL(map.getSize(), static_cast<std::size_t>(keys));
+
+  // writer w removes the odd keys it owns and updates its even ones while the others do the same
+  runWriters([&](int w) {
+    for (int key = w; key < keys; key += writers)
+    {
+      if (key % 2 == 1)
+      {
+        map.remove(key);
+      }
+      else
+      {
+        replaced += !map.upsert(key, key);
+      }
+    }
+  });
+
+  std::map<int, long> expected;
+
+  for (int key = 0; key < keys; key += 2)
+  {
+    expected[key] = key;
+  }
+
+  BOOST_CHECK_EQUAL(replaced.load(), keys / 2);
+  BOOST_CHECK_NO_THROW(map.checkInvariants());
+  BOOST_CHECK(contentsOf(map) == expected);
+  BOOST_CHECK_EQUAL(map.getSize(), expected.size());
+
+  // interleaved upserts and removals of the same keys restructure the paths other writers repair
+  runWriters([&](int w) {
+    std::mt19937 random(100 + w);
+
+    for (int i = 0; i < 40000; ++i)
+    {
+      int key = random() % keys;
+
+      if (random() % 2)
+      {
+        map.upsert(key, i);
+      }
+      else if (map.contains(key))
+      {
+        try
+        {
+          map.remove(key);
+        }
+        catch (const std::out_of_range &)
+        {
+          // removed by another writer in the meantime
+        }
+      }
+    }
+  });
+
+  BOOST_CHECK_NO_THROW(map.checkInvariants());
+  BOOST_CHECK_EQUAL(map.getSize(), contentsOf(map).size());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,150 @@
+#include "../include/TreeMap.h"
+
+#include <cstdint>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <boost/mpl/list.hpp>
+
+template <typename K>
+using Map = aisdi::TreeMap<K, std::string>;
+
+template <typename K>
+using Frozen = aisdi::FrozenTreeMap<K, std::string>;
+
+using TestedKeyTypes = boost::mpl::list<std::int32_t, std::uint64_t>;
+
+BOOST_AUTO_TEST_SUITE(FrozenTreeMapTests)
+
+template <typename K>
+void thenMapIteratesInOrder(const Frozen<K>& map,
+                            const std::map<K, std::string>& expected)
+{
+  BOOST_CHECK_EQUAL(map.getSize(), expected.size());
+
+  auto expectedIt = expected.begin();
+
+  for (auto it = map.begin(); it != map.end(); ++it, ++expectedIt)
+  {
+    BOOST_REQUIRE(expectedIt != expected.end());
+    BOOST_CHECK_EQUAL(it->first, expectedIt->first);
+    BOOST_CHECK_EQUAL(it->second, expectedIt->second);
+  }
+
+  BOOST_CHECK(expectedIt == expected.end());
+
+  auto expectedReverseIt = expected.rbegin();
+
+  for (auto it = map.end(); expectedReverseIt != expected.rend(); ++expectedReverseIt)
+  {
+    --it;
+    BOOST_CHECK_EQUAL(it->first, expectedReverseIt->first);
+  }
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenEmptyMap_WhenFreezing_ThenFrozenMapIsEmpty,
+                              K,
+                              TestedKeyTypes)
+{
+  const Frozen<K> frozen = Map<K>().freeze();
+
+  BOOST_CHECK(frozen.isEmpty());
+  BOOST_CHECK(frozen.begin() == frozen.end());
+  BOOST_CHECK(frozen.find(1) == frozen.end());
+  BOOST_CHECK(frozen.lowerBound(1) == frozen.end());
+  BOOST_CHECK_THROW(--frozen.end(), std::out_of_range);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenMap_WhenFreezing_ThenItemsAreIteratedInOrder,
+                              K,
+                              TestedKeyTypes)
+{
+  const Map<K> map = { { 42, "Alice" }, { 27, "Bob" }, { 13, "Chuck" }, { 7, "Dave" } };
+
+  const auto frozen = map.freeze();
+
+  thenMapIteratesInOrder(frozen, { { 7, "Dave" }, { 13, "Chuck" }, { 27, "Bob" }, { 42, "Alice" } });
+  BOOST_CHECK_THROW(--frozen.begin(), std::out_of_range);
+  BOOST_CHECK_THROW(++frozen.end(), std::out_of_range);
+  BOOST_CHECK_THROW(*frozen.end(), std::out_of_range);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenFrozenMap_WhenSearching_ThenOnlyPresentKeysAreFound,
+                              K,
+                              TestedKeyTypes)
+{
+  const auto frozen = Map<K>({ { 10, "a" }, { 20, "b" }, { 30, "c" } }).freeze();
+
+  BOOST_CHECK_EQUAL(frozen.find(20)->second, "b");
+  BOOST_CHECK_EQUAL(frozen.valueOf(30), "c");
+  BOOST_CHECK(frozen.contains(10));
+  BOOST_CHECK(!frozen.contains(15));
+  BOOST_CHECK(frozen.find(15) == frozen.end());
+  BOOST_CHECK_THROW(frozen.valueOf(15), std::out_of_range);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenFrozenMap_WhenSearchingLowerBound_ThenFirstNotSmallerKeyIsReturned,
+                              K,
+                              TestedKeyTypes)
+{
+  const auto frozen = Map<K>({ { 10, "a" }, { 20, "b" }, { 30, "c" } }).freeze();
+
+  BOOST_CHECK_EQUAL(frozen.lowerBound(0)->first, 10);
+  BOOST_CHECK_EQUAL(frozen.lowerBound(20)->first, 20);
+  BOOST_CHECK_EQUAL(frozen.lowerBound(21)->first, 30);
+  BOOST_CHECK(frozen.lowerBound(31) == frozen.end());
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenMapsOfManySizes_WhenFreezing_ThenFrozenMapMatchesModel,
+                              K,
+                              TestedKeyTypes)
+{
+  std::mt19937 random(13);
+
+  for (int size = 0; size < 200; size += 7)
+  {
+    Map<K> map;
+    std::map<K, std::string> model;
+
+    for (int i = 0; i < size; ++i)
+    {
+      K key = 2 * (random() % 500);
+      map[key] = std::to_string(i);
+      model[key] = std::to_string(i);
+    }
+
+    const auto frozen = map.freeze();
+    thenMapIteratesInOrder(frozen, model);
+
+    for (K key = 0; key < 1002; ++key)
+    {
+      auto expected = model.lower_bound(key);
+      auto result = frozen.lowerBound(key);
+
+      BOOST_REQUIRE_EQUAL(expected == model.end(), result == frozen.end());
+
+      if (expected != model.end())
+      {
+        BOOST_CHECK_EQUAL(result->first, expected->first);
+      }
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenSortedRange_WhenConstructingFrozenMap_ThenItEqualsFrozenTree,
+                              K,
+                              TestedKeyTypes)
+{
+  const std::vector<std::pair<K, std::string>> items = { { 1, "a" }, { 2, "b" }, { 3, "c" } };
+
+  const Frozen<K> frozen(items.begin(), items.end());
+
+  BOOST_CHECK(frozen == Map<K>(items.begin(), items.end()).freeze());
+  BOOST_CHECK(frozen != Map<K>({ { 1, "a" } }).freeze());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -1,4 +1,5 @@
 #include "../include/HashMap.h"
+#include "../include/Counted.h"
 
 #include <cstdint>
 #include <string>
@@ -853,6 +854,28 @@ BOOST_AUTO_TEST_CASE_TEMPLATE(GivenMapWithTwoItems_CheckPostIncrementationOnIter
   BOOST_CHECK((it++)->first == 1);
 }
 
+BOOST_AUTO_TEST_CASE(GivenMapOfCountedKeys_WhenItGrows_ThenResizingCopiesNothing)
+{
+  using Item = aisdi::Counted<int>;
+
+  aisdi::HashMap<Item, Item> map;
+  aisdi::OperationCounts before = aisdi::OperationCounts::current();
+  const std::size_t count = 1000; // enough for six resizes
+
+  for (std::size_t i = 0; i < count; ++i)
+  {
+    map[Item(static_cast<int>(i))] = Item(static_cast<int>(i));
+  }
+
+  aisdi::OperationCounts cost = aisdi::OperationCounts::current() - before;
+
+  // only the key copied into its entry and the default value moved there, once per insert
+  BOOST_CHECK_EQUAL(cost.copies, count);
+  BOOST_CHECK_EQUAL(cost.moves, count);
+  BOOST_CHECK_EQUAL(map.getSize(), count);
+  BOOST_CHECK_EQUAL(map.valueOf(Item(999)).value(), 999);
+}
+
 // ConstIterator is tested via Iterator methods.
 // If Iterator methods are to be changed, then new ConstIterator tests are required.
 
@@ -0,0 +1,168 @@
+#include "../include/PersistentTreeMap.h"
+
+#include <cstdint>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <boost/mpl/list.hpp>
+
+template <typename K>
+using Map = aisdi::PersistentTreeMap<K, std::string>;
+
+using TestedKeyTypes = boost::mpl::list<std::int32_t, std::uint64_t>;
+
+BOOST_AUTO_TEST_SUITE(PersistentTreeMapTests)
+
+template <typename K>
+void thenMapIteratesInOrder(const Map<K>& map,
+                            const std::map<K, std::string>& expected)
+{
+  BOOST_CHECK_EQUAL(map.getSize(), expected.size());
+
+  auto expectedIt = expected.begin();
+
+  for (auto it = map.begin(); it != map.end(); ++it, ++expectedIt)
+  {
+    BOOST_REQUIRE(expectedIt != expected.end());
+    BOOST_CHECK_EQUAL(it->first, expectedIt->first);
+    BOOST_CHECK_EQUAL(it->second, expectedIt->second);
+  }
+
+  BOOST_CHECK(expectedIt == expected.end());
+
+  auto expectedReverseIt = expected.rbegin();
+
+  for (auto it = map.end(); expectedReverseIt != expected.rend(); ++expectedReverseIt)
+  {
+    --it;
+    BOOST_CHECK_EQUAL(it->first, expectedReverseIt->first);
+  }
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenMap_WhenCreatedWithDefaultConstructor_ThenItIsEmpty,
+                              K,
+                              TestedKeyTypes)
+{
+  const Map<K> map;
+
+  BOOST_CHECK(map.isEmpty());
+  BOOST_CHECK(map.begin() == map.end());
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenMap_WhenInserting_ThenOldVersionIsUnchanged,
+                              K,
+                              TestedKeyTypes)
+{
+  const Map<K> map = { { 42, "Alice" }, { 27, "Bob" } };
+
+  const auto newer = map.insert(13, "Chuck").insert(42, "Dave");
+
+  thenMapIteratesInOrder(map, { { 27, "Bob" }, { 42, "Alice" } });
+  thenMapIteratesInOrder(newer, { { 13, "Chuck" }, { 27, "Bob" }, { 42, "Dave" } });
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenMap_WhenRemoving_ThenOldVersionIsUnchanged,
+                              K,
+                              TestedKeyTypes)
+{
+  const Map<K> map = { { 42, "Alice" }, { 27, "Bob" }, { 13, "Chuck" } };
+
+  const auto newer = map.remove(27);
+
+  thenMapIteratesInOrder(map, { { 13, "Chuck" }, { 27, "Bob" }, { 42, "Alice" } });
+  thenMapIteratesInOrder(newer, { { 13, "Chuck" }, { 42, "Alice" } });
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenMap_WhenRemovingMissingKey_ThenExceptionIsThrown,
+                              K,
+                              TestedKeyTypes)
+{
+  const Map<K> map = { { 42, "Alice" } };
+
+  BOOST_CHECK_THROW(map.remove(27), std::out_of_range);
+  BOOST_CHECK_THROW(Map<K>().remove(27), std::out_of_range);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenMap_WhenReadingValueOfMissingKey_ThenExceptionIsThrown,
+                              K,
+                              TestedKeyTypes)
+{
+  const Map<K> map = { { 42, "Alice" } };
+
+  BOOST_CHECK_EQUAL(map.valueOf(42), "Alice");
+  BOOST_CHECK_THROW(map.valueOf(27), std::out_of_range);
+  BOOST_CHECK(map.find(27) == map.end());
+  BOOST_CHECK_EQUAL(map.find(42)->second, "Alice");
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenIterator_WhenMapIsReassigned_ThenIteratorStillSeesItsVersion,
+                              K,
+                              TestedKeyTypes)
+{
+  Map<K> map = { { 1, "a" }, { 2, "b" }, { 3, "c" } };
+
+  auto it = map.begin();
+  map = map.remove(2).remove(3);
+
+  ++it;
+
+  BOOST_CHECK_EQUAL(it->first, 2);
+  BOOST_CHECK_EQUAL((++it)->second, "c");
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenBeginAndEndIterators_WhenMovingPastThem_ThenOperationThrows,
+                              K,
+                              TestedKeyTypes)
+{
+  const Map<K> empty;
+  const Map<K> map = { { 1, "a" } };
+
+  BOOST_CHECK_THROW(++empty.end(), std::out_of_range);
+  BOOST_CHECK_THROW(--empty.end(), std::out_of_range);
+  BOOST_CHECK_THROW(--map.begin(), std::out_of_range);
+  BOOST_CHECK_THROW(*map.end(), std::out_of_range);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenManyVersions_WhenComparedToModel_ThenEachVersionIsIntact,
+                              K,
+                              TestedKeyTypes)
+{
+  std::mt19937 random(7);
+  std::vector<Map<K>> versions(1);
+  std::vector<std::map<K, std::string>> models(1);
+
+  for (int i = 0; i < 2000; ++i)
+  {
+    K key = random() % 300;
+    Map<K> next = versions.back();
+    std::map<K, std::string> model = models.back();
+
+    if (model.count(key) && random() % 2)
+    {
+      next = next.remove(key);
+      model.erase(key);
+    }
+    else
+    {
+      next = next.insert(key, std::to_string(i));
+      model[key] = std::to_string(i);
+    }
+
+    versions.push_back(next);
+    models.push_back(model);
+  }
+
+  for (std::size_t i = 0; i < versions.size(); i += 97)
+  {
+    thenMapIteratesInOrder(versions[i], models[i]);
+  }
+
+  BOOST_CHECK(versions.back() == Map<K>(versions.back()));
+  BOOST_CHECK(versions.back() != versions[versions.size() / 2]);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
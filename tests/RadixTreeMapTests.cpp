@@ -0,0 +1,231 @@
+#include "../include/RadixTreeMap.h"
+
+#include <cstdint>
+#include <map>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+#include <boost/mpl/list.hpp>
+
+using TestedMaps = boost::mpl::list<aisdi::RadixTreeMap<std::int32_t, std::string>,
+                                    aisdi::RadixTreeMap<std::uint64_t, std::string>>;
+
+BOOST_AUTO_TEST_SUITE(RadixTreeMapTests)
+
+template <typename Map>
+void thenMapIteratesInOrder(const Map& map,
+                            const std::map<typename Map::key_type, std::string>& expected)
+{
+  BOOST_CHECK_EQUAL(map.getSize(), expected.size());
+
+  auto expectedIt = expected.begin();
+
+  for (auto it = map.begin(); it != map.end(); ++it, ++expectedIt)
+  {
+    BOOST_REQUIRE(expectedIt != expected.end());
+    BOOST_CHECK_EQUAL(it->first, expectedIt->first);
+    BOOST_CHECK_EQUAL(it->second, expectedIt->second);
+  }
+
+  BOOST_CHECK(expectedIt == expected.end());
+
+  auto expectedReverseIt = expected.rbegin();
+
+  for (auto it = map.end(); expectedReverseIt != expected.rend(); ++expectedReverseIt)
+  {
+    --it;
+    BOOST_CHECK_EQUAL(it->first, expectedReverseIt->first);
+  }
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenMap_WhenCreatedWithDefaultConstructor_ThenItIsEmpty,
+                              Map,
+                              TestedMaps)
+{
+  const Map map;
+
+  BOOST_CHECK(map.isEmpty());
+  BOOST_CHECK(map.begin() == map.end());
+  BOOST_CHECK(map.lowerBound(1) == map.end());
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenMap_WhenAddingItems_ThenTheyAreIteratedInOrder,
+                              Map,
+                              TestedMaps)
+{
+  Map map = { { 42, "Alice" }, { 27, "Bob" }, { 256, "Eve" } };
+  map[13] = "Chuck";
+  map[42] = "Dave";
+
+  BOOST_CHECK(!map.upsert(27, "Bill"));
+  BOOST_CHECK(map.upsert(1, "Fred"));
+
+  thenMapIteratesInOrder(map, { { 1, "Fred" }, { 13, "Chuck" }, { 27, "Bill" }, { 42, "Dave" }, { 256, "Eve" } });
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenMap_WhenRemovingItems_ThenRemainingItemsAreIntact,
+                              Map,
+                              TestedMaps)
+{
+  Map map = { { 1, "a" }, { 2, "b" }, { 3, "c" }, { 4, "d" }, { 5, "e" } };
+
+  map.remove(2);
+  map.remove(map.find(4));
+
+  thenMapIteratesInOrder(map, { { 1, "a" }, { 3, "c" }, { 5, "e" } });
+  BOOST_CHECK_EQUAL(map.valueOf(5), "e");
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenMap_WhenAccessingMissingKey_ThenExceptionIsThrown,
+                              Map,
+                              TestedMaps)
+{
+  Map map = { { 42, "Alice" } };
+  const Map& constMap = map;
+
+  BOOST_CHECK_THROW(map.remove(27), std::out_of_range);
+  BOOST_CHECK_THROW(map.valueOf(27), std::out_of_range);
+  BOOST_CHECK_THROW(constMap.valueOf(27), std::out_of_range);
+  BOOST_CHECK(map.find(27) == map.end());
+  BOOST_CHECK_EQUAL(map.getSize(), 1u);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenBeginAndEndIterators_WhenMovingPastThem_ThenOperationThrows,
+                              Map,
+                              TestedMaps)
+{
+  const Map empty;
+  const Map map = { { 1, "a" } };
+
+  BOOST_CHECK_THROW(++empty.end(), std::out_of_range);
+  BOOST_CHECK_THROW(--empty.end(), std::out_of_range);
+  BOOST_CHECK_THROW(--map.begin(), std::out_of_range);
+  BOOST_CHECK_THROW(*map.end(), std::out_of_range);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenMap_WhenCopyingAndMoving_ThenContentsFollow,
+                              Map,
+                              TestedMaps)
+{
+  Map map = { { 1, "a" }, { 2, "b" } };
+
+  Map copy = map;
+  copy[3] = "c";
+
+  BOOST_CHECK(copy != map);
+  BOOST_CHECK_EQUAL(map.getSize(), 2u);
+
+  Map moved = std::move(copy);
+
+  BOOST_CHECK(copy.isEmpty());
+  thenMapIteratesInOrder(moved, { { 1, "a" }, { 2, "b" }, { 3, "c" } });
+
+  moved.remove(3);
+
+  BOOST_CHECK(moved == map);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenMap_WhenScanningRange_ThenKeysInRangeAreVisitedInOrder,
+                              Map,
+                              TestedMaps)
+{
+  Map map;
+
+  for (int i = 0; i < 1000; i += 10)
+  {
+    map[i] = std::to_string(i);
+  }
+
+  std::vector<typename Map::key_type> keys;
+  map.forEachInRange(95, 140, [&](const auto& key, const std::string&) { keys.push_back(key); });
+
+  BOOST_CHECK((keys == std::vector<typename Map::key_type>{ 100, 110, 120, 130 }));
+  BOOST_CHECK_EQUAL(map.lowerBound(95)->first, 100);
+  BOOST_CHECK_EQUAL(map.lowerBound(100)->first, 100);
+  BOOST_CHECK(map.lowerBound(991) == map.end());
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenRandomOperations_WhenComparedToModel_ThenMapMatches,
+                              Map,
+                              TestedMaps)
+{
+  std::mt19937 random(11);
+  Map map;
+  std::map<typename Map::key_type, std::string> model;
+
+  for (int i = 0; i < 20000; ++i)
+  {
+    // a few dense clusters far apart, so all node sizes and long prefixes are used
+    typename Map::key_type key = (random() % 4) * 1000003 + random() % 300;
+
+    if (model.count(key) && random() % 2)
+    {
+      map.remove(key);
+      model.erase(key);
+    }
+    else
+    {
+      map[key] = std::to_string(i);
+      model[key] = std::to_string(i);
+    }
+
+    if (i % 997 == 0)
+    {
+      thenMapIteratesInOrder(map, model);
+    }
+  }
+
+  thenMapIteratesInOrder(map, model);
+}
+
+BOOST_AUTO_TEST_CASE(GivenSignedKeys_WhenIterating_ThenNegativeKeysComeFirst)
+{
+  aisdi::RadixTreeMap<std::int32_t, std::string> map = { { 5, "a" }, { -1, "b" }, { -300, "c" }, { 0, "d" } };
+
+  thenMapIteratesInOrder(map, { { -300, "c" }, { -1, "b" }, { 0, "d" }, { 5, "a" } });
+}
+
+BOOST_AUTO_TEST_CASE(GivenStringKeysBeingPrefixesOfEachOther_WhenIterating_ThenShorterKeyComesFirst)
+{
+  aisdi::RadixTreeMap<std::string, std::string> map = { { "cart", "a" }, { "car", "b" }, { "", "c" }, { "carbon", "d" } };
+
+  thenMapIteratesInOrder(map, { { "", "c" }, { "car", "b" }, { "carbon", "d" }, { "cart", "a" } });
+
+  map.remove("car");
+
+  BOOST_CHECK(map.find("car") == map.end());
+  BOOST_CHECK_EQUAL(map.valueOf("cart"), "a");
+  thenMapIteratesInOrder(map, { { "", "c" }, { "carbon", "d" }, { "cart", "a" } });
+}
+
+BOOST_AUTO_TEST_CASE(GivenStringKeysWithLongCommonPrefix_WhenSearching_ThenOnlyPresentKeysAreFound)
+{
+  const std::string base = "https://example.com/a/very/long/path/";
+  aisdi::RadixTreeMap<std::string, int> map = { { base + "x", 1 }, { base + "y", 2 } };
+
+  BOOST_CHECK_EQUAL(map.valueOf(base + "y"), 2);
+  BOOST_CHECK(map.find(base.substr(0, 20) + "?" + base.substr(21) + "x") == map.end());
+  BOOST_CHECK(map.find(base) == map.end());
+
+  map[base] = 3;
+  map["https://example.com/b"] = 4;
+
+  BOOST_CHECK_EQUAL(map.valueOf(base), 3);
+  BOOST_CHECK_EQUAL(map.lowerBound("https://example.com/a/very/long/path/xa")->second, 2);
+}
+
+BOOST_AUTO_TEST_CASE(GivenStringKeys_WhenScanningPrefix_ThenOnlyKeysWithPrefixAreVisited)
+{
+  const aisdi::RadixTreeMap<std::string, int> map = { { "car", 1 }, { "cart", 2 }, { "carbon", 3 }, { "cat", 4 }, { "ca", 5 } };
+
+  std::vector<std::string> keys;
+  map.forEachWithPrefix("car", [&](const std::string& key, int) { keys.push_back(key); });
+
+  BOOST_CHECK((keys == std::vector<std::string>{ "car", "carbon", "cart" }));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
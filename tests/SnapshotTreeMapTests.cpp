@@ -0,0 +1,103 @@
+#include "../include/SnapshotTreeMap.h"
+
+#include <atomic>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <boost/test/unit_test.hpp>
+
+using Map = aisdi::SnapshotTreeMap<int, std::string>;
+
+BOOST_AUTO_TEST_SUITE(SnapshotTreeMapTests)
+
+BOOST_AUTO_TEST_CASE(GivenEmptyMap_WhenInserting_ThenItemIsInMap)
+{
+  Map map;
+
+  map.insert(42, "Alice");
+
+  BOOST_CHECK(!map.isEmpty());
+  BOOST_CHECK_EQUAL(map.getSize(), 1u);
+  BOOST_CHECK_EQUAL(map.valueOf(42), "Alice");
+}
+
+BOOST_AUTO_TEST_CASE(GivenSnapshot_WhenMapIsModified_ThenSnapshotIsUnchanged)
+{
+  Map map = { { 42, "Alice" }, { 27, "Bob" } };
+
+  auto snapshot = map.snapshot();
+
+  map.insert(13, "Chuck");
+  map.insert(42, "Dave");
+  map.remove(27);
+
+  BOOST_CHECK_EQUAL(snapshot.getSize(), 2u);
+  BOOST_CHECK_EQUAL(snapshot.valueOf(42), "Alice");
+  BOOST_CHECK_EQUAL(snapshot.valueOf(27), "Bob");
+  BOOST_CHECK(snapshot.find(13) == snapshot.end());
+
+  BOOST_CHECK_EQUAL(map.getSize(), 2u);
+  BOOST_CHECK_EQUAL(map.valueOf(42), "Dave");
+  BOOST_CHECK_THROW(map.valueOf(27), std::out_of_range);
+}
+
+BOOST_AUTO_TEST_CASE(GivenMap_WhenRemovingMissingKey_ThenExceptionIsThrownAndMapIsUnchanged)
+{
+  Map map = { { 42, "Alice" } };
+
+  BOOST_CHECK_THROW(map.remove(27), std::out_of_range);
+  BOOST_CHECK_EQUAL(map.getSize(), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(GivenConcurrentWriter_WhenScanningSnapshots_ThenEachSnapshotIsConsistent)
+{
+  Map map;
+  std::atomic<bool> finished{false};
+  std::atomic<int> inconsistentScans{0};
+
+  std::vector<std::thread> readers;
+
+  for (int i = 0; i < 3; ++i)
+  {
+    readers.emplace_back([&] {
+      while (!finished.load())
+      {
+        // the writer appends keys in increasing order, so a snapshot must hold exactly 0..size-1
+        auto snapshot = map.snapshot();
+        int expected = 0;
+
+        for (const auto &item : snapshot)
+        {
+          if (item.first != expected++)
+          {
+            ++inconsistentScans;
+          }
+        }
+
+        if (static_cast<std::size_t>(expected) != snapshot.getSize())
+        {
+          ++inconsistentScans;
+        }
+      }
+    });
+  }
+
+  for (int i = 0; i < 5000; ++i)
+  {
+    map.insert(i, std::to_string(i));
+  }
+
+  finished = true;
+
+  for (auto &reader : readers)
+  {
+    reader.join();
+  }
+
+  BOOST_CHECK_EQUAL(inconsistentScans.load(), 0);
+  BOOST_CHECK_EQUAL(map.getSize(), 5000u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
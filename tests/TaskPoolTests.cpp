@@ -0,0 +1,83 @@
+#include "../include/TaskPool.h"
+
+#include <atomic>
+#include <stdexcept>
+
+#include <boost/test/unit_test.hpp>
+
+namespace
+{
+
+long sumRange(aisdi::TaskPool& pool, long first, long last)
+{
+  if (last - first <= 64)
+  {
+    long sum = 0;
+
+    for (long i = first; i < last; ++i)
+    {
+      sum += i;
+    }
+
+    return sum;
+  }
+
+  long middle = first + (last - first) / 2;
+  long left = 0;
+  long right = 0;
+
+  pool.invoke([&] { left = sumRange(pool, first, middle); },
+              [&] { right = sumRange(pool, middle, last); });
+
+  return left + right;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(TaskPoolTests)
+
+BOOST_AUTO_TEST_CASE(GivenSingleThreadPool_WhenInvoking_ThenBothFunctionsAreRun)
+{
+  aisdi::TaskPool pool(1);
+  int first = 0;
+  int second = 0;
+
+  pool.invoke([&] { first = 1; }, [&] { second = 2; });
+
+  BOOST_CHECK_EQUAL(pool.getThreadCount(), 1u);
+  BOOST_CHECK_EQUAL(first, 1);
+  BOOST_CHECK_EQUAL(second, 2);
+}
+
+BOOST_AUTO_TEST_CASE(GivenPool_WhenRecursivelyInvoking_ThenAllTasksAreRun)
+{
+  aisdi::TaskPool pool(4);
+
+  BOOST_CHECK_EQUAL(sumRange(pool, 0, 100000), 100000L * 99999L / 2);
+}
+
+BOOST_AUTO_TEST_CASE(GivenPool_WhenManyTasksAreForked_ThenEachIsRunExactlyOnce)
+{
+  aisdi::TaskPool pool(4);
+  std::atomic<int> counter{0};
+
+  for (int i = 0; i < 1000; ++i)
+  {
+    pool.invoke([&] { ++counter; }, [&] { ++counter; });
+  }
+
+  BOOST_CHECK_EQUAL(counter.load(), 2000);
+}
+
+BOOST_AUTO_TEST_CASE(GivenPool_WhenForkedFunctionThrows_ThenExceptionIsRethrown)
+{
+  aisdi::TaskPool pool(4);
+  bool firstFinished = false;
+
+  BOOST_CHECK_THROW(pool.invoke([&] { firstFinished = true; },
+                                [] { throw std::runtime_error("failure"); }),
+                    std::runtime_error);
+  BOOST_CHECK(firstFinished);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -1,8 +1,14 @@
 #include "../include/TreeMap.h"
+#include "../include/Counted.h"
 
+#include <cctype>
 #include <cstdint>
+#include <functional>
 #include <string>
+#include <string_view>
 #include <map>
+#include <random>
+#include <vector>
 
 #include <boost/test/unit_test.hpp>
 
@@ -129,6 +135,8 @@ template <typename K>
 using Map = aisdi::TreeMap<K, std::string>;
 
 using TestedKeyTypes = boost::mpl::list<std::int32_t, std::uint64_t, OperationCountingObject>;
+// OperationCountingObject counters are not thread-safe
+using ParallelTestedKeyTypes = boost::mpl::list<std::int32_t, std::uint64_t>;
 using std::begin;
 using std::end;
 
@@ -151,6 +159,32 @@ void thenMapContainsItems(const Map<K>& map,
   }
 }
 
+template <typename K>
+void thenMapIteratesInOrder(const Map<K>& map,
+                            const std::map<K, std::string>& expected)
+{
+  BOOST_CHECK_EQUAL(map.getSize(), expected.size());
+
+  auto expectedIt = expected.begin();
+
+  for (auto it = map.begin(); it != map.end(); ++it, ++expectedIt)
+  {
+    BOOST_REQUIRE(expectedIt != expected.end());
+    BOOST_CHECK_EQUAL(it->first, expectedIt->first);
+    BOOST_CHECK_EQUAL(it->second, expectedIt->second);
+  }
+
+  BOOST_CHECK(expectedIt == expected.end());
+
+  auto expectedReverseIt = expected.rbegin();
+
+  for (auto it = map.end(); expectedReverseIt != expected.rend(); ++expectedReverseIt)
+  {
+    --it;
+    BOOST_CHECK_EQUAL(it->first, expectedReverseIt->first);
+  }
+}
+
 template <typename T>
 void thenConstructedObjectsCountWas(std::size_t count)
 {
@@ -863,6 +897,858 @@ BOOST_AUTO_TEST_CASE_TEMPLATE(GivenMapWithTwoItems_CheckPostIncrementationOnIter
   BOOST_CHECK((it++)->first == 1);
 }
 
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenSortedRange_WhenBuildingFromSorted_ThenAllItemsAreInMap,
+                              K,
+                              TestedKeyTypes)
+{
+  std::vector<std::pair<K, std::string>> items;
+
+  for (int i = 0; i < 100; ++i)
+  {
+    items.emplace_back(i, std::to_string(i));
+  }
+
+  auto map = Map<K>::fromSorted(items.begin(), items.end());
+
+  std::map<K, std::string> expected(items.begin(), items.end());
+  thenMapContainsItems(map, expected);
+  BOOST_CHECK_EQUAL(map.begin()->first, 0);
+  BOOST_CHECK_EQUAL((--map.end())->first, 99);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenMapBuiltFromSorted_WhenIterating_ThenItemsAreInOrder,
+                              K,
+                              TestedKeyTypes)
+{
+  std::vector<std::pair<K, std::string>> items;
+
+  for (int i = 0; i < 37; ++i)
+  {
+    items.emplace_back(2 * i, "x");
+  }
+
+  const auto map = Map<K>::fromSorted(items.begin(), items.end());
+
+  int expected = 0;
+
+  for (auto it = map.begin(); it != map.end(); ++it, expected += 2)
+  {
+    BOOST_CHECK_EQUAL(it->first, expected);
+  }
+
+  BOOST_CHECK_EQUAL(expected, 74);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenMapBuiltFromSorted_WhenAddingAndRemovingItems_ThenMapStaysConsistent,
+                              K,
+                              TestedKeyTypes)
+{
+  std::vector<std::pair<K, std::string>> items;
+  std::map<K, std::string> expected;
+
+  for (int i = 0; i < 64; ++i)
+  {
+    items.emplace_back(2 * i, "even");
+    expected[2 * i] = "even";
+  }
+
+  auto map = Map<K>::fromSorted(items.begin(), items.end());
+
+  for (int i = 0; i < 64; i += 3)
+  {
+    map[2 * i + 1] = "odd";
+    expected[2 * i + 1] = "odd";
+    map.remove(2 * i);
+    expected.erase(2 * i);
+  }
+
+  thenMapContainsItems(map, expected);
+  BOOST_CHECK_EQUAL(map.begin()->first, expected.begin()->first);
+  BOOST_CHECK_EQUAL((--map.end())->first, expected.rbegin()->first);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenEmptyRange_WhenBuildingFromSorted_ThenMapIsEmpty,
+                              K,
+                              TestedKeyTypes)
+{
+  std::vector<std::pair<K, std::string>> items;
+
+  const auto map = Map<K>::fromSorted(items.begin(), items.end());
+
+  BOOST_CHECK(map.isEmpty());
+  BOOST_CHECK(map.begin() == map.end());
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenUnsortedRangeWithDuplicates_WhenConstructingFromRange_ThenLastValueWins,
+                              K,
+                              TestedKeyTypes)
+{
+  std::vector<std::pair<K, std::string>> items = { { 42, "Alice" }, { 27, "Bob" }, { 42, "Chuck" } };
+
+  const Map<K> map(items.begin(), items.end());
+
+  thenMapContainsItems(map, { { 27, "Bob" }, { 42, "Chuck" } });
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenMap_WhenSplitting_ThenGreaterOrEqualKeysAreMovedToResult,
+                              K,
+                              TestedKeyTypes)
+{
+  for (int splitKey = 0; splitKey <= 41; ++splitKey)
+  {
+    Map<K> map;
+    std::map<K, std::string> smaller;
+    std::map<K, std::string> greater;
+
+    for (int i = 0; i < 40; i += 2)
+    {
+      map[i] = std::to_string(i);
+      (i < splitKey ? smaller : greater)[i] = std::to_string(i);
+    }
+
+    auto other = map.split(splitKey);
+
+    thenMapIteratesInOrder(map, smaller);
+    thenMapIteratesInOrder(other, greater);
+  }
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenTwoMaps_WhenJoining_ThenResultContainsAllItems,
+                              K,
+                              TestedKeyTypes)
+{
+  Map<K> left;
+  Map<K> right;
+  std::map<K, std::string> expected;
+
+  for (int i = 0; i < 5; ++i)
+  {
+    left[i] = "left";
+    expected[i] = "left";
+  }
+
+  for (int i = 100; i < 150; ++i)
+  {
+    right[i] = "right";
+    expected[i] = "right";
+  }
+
+  auto joined = Map<K>::join(std::move(left), std::move(right));
+
+  thenMapIteratesInOrder(joined, expected);
+  BOOST_CHECK(left.isEmpty());
+  BOOST_CHECK(right.isEmpty());
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenOverlappingMaps_WhenJoining_ThenExceptionIsThrown,
+                              K,
+                              TestedKeyTypes)
+{
+  Map<K> left = { { 1, "Alice" }, { 50, "Bob" } };
+  Map<K> right = { { 10, "Chuck" } };
+
+  BOOST_CHECK_THROW(Map<K>::join(std::move(left), std::move(right)), std::invalid_argument);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenTwoMaps_WhenUnionWith_ThenAllKeysArePresentAndOwnValuesKept,
+                              K,
+                              TestedKeyTypes)
+{
+  Map<K> map;
+  Map<K> other;
+  std::map<K, std::string> expected;
+
+  for (int i = 0; i < 90; i += 3)
+  {
+    map[i] = "mine";
+    expected[i] = "mine";
+  }
+
+  for (int i = 0; i < 120; i += 2)
+  {
+    other[i] = "theirs";
+    expected.emplace(i, "theirs");
+  }
+
+  map.unionWith(other);
+
+  thenMapIteratesInOrder(map, expected);
+  BOOST_CHECK_EQUAL(other.getSize(), 60u);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenTwoMaps_WhenIntersectWith_ThenOnlyCommonKeysRemain,
+                              K,
+                              TestedKeyTypes)
+{
+  Map<K> map;
+  Map<K> other;
+  std::map<K, std::string> expected;
+
+  for (int i = 0; i < 90; i += 3)
+  {
+    map[i] = "mine";
+  }
+
+  for (int i = 0; i < 120; i += 2)
+  {
+    other[i] = "theirs";
+
+    if (i % 3 == 0 && i < 90)
+    {
+      expected[i] = "mine";
+    }
+  }
+
+  map.intersectWith(other);
+
+  thenMapIteratesInOrder(map, expected);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenTwoMaps_WhenDifference_ThenKeysOfOtherAreRemoved,
+                              K,
+                              TestedKeyTypes)
+{
+  Map<K> map;
+  Map<K> other;
+  std::map<K, std::string> expected;
+
+  for (int i = 0; i < 90; i += 3)
+  {
+    map[i] = "mine";
+
+    if (i % 2 != 0)
+    {
+      expected[i] = "mine";
+    }
+  }
+
+  for (int i = 0; i < 120; i += 2)
+  {
+    other[i] = "theirs";
+  }
+
+  map.difference(other);
+
+  thenMapIteratesInOrder(map, expected);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenMap_WhenDifferenceWithItself_ThenMapBecomesEmpty,
+                              K,
+                              TestedKeyTypes)
+{
+  Map<K> map = { { 42, "Alice" }, { 27, "Bob" } };
+
+  map.difference(map);
+
+  BOOST_CHECK(map.isEmpty());
+  BOOST_CHECK(map.begin() == map.end());
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenTwoMaps_WhenMergingFromRvalue_ThenNodesAreReusedWithoutCopies,
+                              K,
+                              TestedKeyTypes)
+{
+  Map<K> map;
+  Map<K> other;
+  std::map<K, std::string> expected;
+
+  for (int i = 0; i < 200; i += 5)
+  {
+    map[i] = "mine";
+    expected[i] = "mine";
+  }
+
+  for (int i = 0; i < 300; i += 7)
+  {
+    other[i] = "theirs";
+    expected.emplace(i, "theirs");
+  }
+
+  OperationCountingObject::resetCounters();
+  map.mergeFrom(std::move(other));
+
+  thenConstructedObjectsCountWas<K>(0);
+  thenCopiedObjectsCountWas<K>(0);
+  thenMovedObjectsCountWas<K>(0);
+  thenMapIteratesInOrder(map, expected);
+  BOOST_CHECK(other.isEmpty());
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenLargeMap_WhenCopyingInParallel_ThenAllItemsAreCopied,
+                              K,
+                              ParallelTestedKeyTypes)
+{
+  aisdi::TaskPool pool(4);
+  Map<K> map;
+  std::map<K, std::string> expected;
+
+  for (int i = 0; i < 20000; ++i)
+  {
+    map[i * 7 % 20011] = std::to_string(i);
+    expected[i * 7 % 20011] = std::to_string(i);
+  }
+
+  const Map<K> other(map, pool);
+
+  thenMapIteratesInOrder(other, expected);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenLargeMap_WhenClearingInParallel_ThenMapIsEmpty,
+                              K,
+                              ParallelTestedKeyTypes)
+{
+  aisdi::TaskPool pool(4);
+  Map<K> map;
+
+  for (int i = 0; i < 20000; ++i)
+  {
+    map[i] = "x";
+  }
+
+  map.clear(pool);
+
+  BOOST_CHECK(map.isEmpty());
+  BOOST_CHECK(map.begin() == map.end());
+
+  map[1] = "y";
+
+  thenMapIteratesInOrder(map, { { 1, "y" } });
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenLargeSortedRange_WhenBuildingInParallel_ThenAllItemsAreInMap,
+                              K,
+                              ParallelTestedKeyTypes)
+{
+  aisdi::TaskPool pool(4);
+  std::vector<std::pair<K, std::string>> items;
+
+  for (int i = 0; i < 30000; ++i)
+  {
+    items.emplace_back(i, std::to_string(i));
+  }
+
+  const auto map = Map<K>::fromSorted(items.begin(), items.end(), pool);
+  const Map<K> other(items.begin(), items.end(), pool);
+
+  thenMapIteratesInOrder(map, std::map<K, std::string>(items.begin(), items.end()));
+  BOOST_CHECK(map == other);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenUnsortedRange_WhenConstructingInParallel_ThenLastValueWins,
+                              K,
+                              ParallelTestedKeyTypes)
+{
+  aisdi::TaskPool pool(4);
+  std::vector<std::pair<K, std::string>> items;
+  std::map<K, std::string> expected;
+
+  for (int i = 0; i < 30000; ++i)
+  {
+    items.emplace_back(i * 13 % 9973, std::to_string(i));
+    expected[i * 13 % 9973] = std::to_string(i);
+  }
+
+  const Map<K> map(items.begin(), items.end(), pool);
+
+  thenMapIteratesInOrder(map, expected);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenLargeMaps_WhenUnionAndIntersectionInParallel_ThenResultsMatchSequential,
+                              K,
+                              ParallelTestedKeyTypes)
+{
+  aisdi::TaskPool pool(4);
+  Map<K> map;
+  Map<K> other;
+
+  for (int i = 0; i < 60000; i += 2)
+  {
+    map[i] = "mine";
+  }
+
+  for (int i = 0; i < 60000; i += 3)
+  {
+    other[i] = "theirs";
+  }
+
+  Map<K> parallelUnion(map);
+  Map<K> sequentialUnion(map);
+  parallelUnion.unionWith(other, pool);
+  sequentialUnion.unionWith(other);
+
+  Map<K> parallelIntersection(map);
+  Map<K> sequentialIntersection(map);
+  parallelIntersection.intersectWith(other, pool);
+  sequentialIntersection.intersectWith(other);
+
+  BOOST_CHECK_EQUAL(parallelUnion.getSize(), 40000u);
+  BOOST_CHECK(parallelUnion == sequentialUnion);
+  BOOST_CHECK_EQUAL(parallelIntersection.getSize(), 10000u);
+  BOOST_CHECK(parallelIntersection == sequentialIntersection);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenMap_WhenAppendingAndPrependingKeys_ThenItemsAreInOrder,
+                              K,
+                              TestedKeyTypes)
+{
+  Map<K> map;
+  std::map<K, std::string> expected;
+
+  for (int i = 100; i < 1100; ++i)
+  {
+    map[i] = std::to_string(i);
+    expected[i] = std::to_string(i);
+  }
+
+  for (int i = 99; i >= 0; --i)
+  {
+    map[i] = std::to_string(i);
+    expected[i] = std::to_string(i);
+  }
+
+  thenMapIteratesInOrder(map, expected);
+  BOOST_CHECK_EQUAL(map.begin()->first, 0);
+  BOOST_CHECK_EQUAL((--map.end())->first, 1099);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenMap_WhenInsertingWithCorrectHints_ThenItemsAreInserted,
+                              K,
+                              TestedKeyTypes)
+{
+  Map<K> map = { { 10, "a" }, { 20, "b" } };
+
+  auto it = map.insertHint(map.end(), 30, "c");
+  BOOST_CHECK_EQUAL(it->first, 30);
+
+  it = map.insertHint(map.find(20), 15, "d");
+  BOOST_CHECK_EQUAL(it->second, "d");
+
+  it = map.insertHint(map.begin(), 5, "e");
+  BOOST_CHECK(it == map.begin());
+
+  thenMapIteratesInOrder(map, { { 5, "e" }, { 10, "a" }, { 15, "d" }, { 20, "b" }, { 30, "c" } });
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenMap_WhenInsertingWithWrongHintOrExistingKey_ThenValueIsStillSet,
+                              K,
+                              TestedKeyTypes)
+{
+  Map<K> map = { { 10, "a" }, { 20, "b" } };
+
+  map.insertHint(map.begin(), 30, "c");
+  map.insertHint(map.end(), 10, "d");
+  map.insertHint(Map<K>().end(), 15, "e");
+
+  thenMapIteratesInOrder(map, { { 10, "d" }, { 15, "e" }, { 20, "b" }, { 30, "c" } });
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenMap_WhenMixingHintedInsertsAndRemovals_ThenMapStaysConsistent,
+                              K,
+                              TestedKeyTypes)
+{
+  Map<K> map;
+  std::map<K, std::string> expected;
+
+  for (int i = 0; i < 2000; ++i)
+  {
+    K key = i * 7919 % 4001;
+    auto next = expected.upper_bound(key);
+    auto hint = next == expected.end() ? map.end() : map.find(next->first);
+
+    map.insertHint(hint, key, std::to_string(i));
+    expected[key] = std::to_string(i);
+
+    if (i % 3 == 0)
+    {
+      map.remove(expected.begin()->first);
+      expected.erase(expected.begin());
+    }
+  }
+
+  thenMapIteratesInOrder(map, expected);
+}
+
+namespace
+{
+
+// three-way comparator ignoring letter case
+struct CaseInsensitiveCompare
+{
+  int operator()(const std::string& a, const std::string& b) const
+  {
+    for (std::size_t i = 0; i < a.size() && i < b.size(); ++i)
+    {
+      int difference = std::tolower(a[i]) - std::tolower(b[i]);
+
+      if (difference != 0)
+      {
+        return difference;
+      }
+    }
+
+    return static_cast<int>(a.size()) - static_cast<int>(b.size());
+  }
+};
+
+struct CountingLess
+{
+  std::size_t* comparisons;
+
+  bool operator()(int a, int b) const
+  {
+    ++*comparisons;
+    return a < b;
+  }
+};
+
+} // namespace
+
+BOOST_AUTO_TEST_CASE(GivenGreaterCompare_WhenIterating_ThenItemsAreInDescendingOrder)
+{
+  aisdi::TreeMap<int, std::string, std::greater<int>> map = { { 1, "a" }, { 3, "c" }, { 2, "b" } };
+  map[0] = "z";
+  map[4] = "d";
+  map.remove(2);
+
+  std::vector<int> keys;
+
+  for (const auto& item : map)
+  {
+    keys.push_back(item.first);
+  }
+
+  BOOST_CHECK((keys == std::vector<int>{ 4, 3, 1, 0 }));
+  BOOST_CHECK_EQUAL(map.valueOf(3), "c");
+  BOOST_CHECK_EQUAL(map.freeze().lowerBound(2)->first, 1);
+}
+
+BOOST_AUTO_TEST_CASE(GivenThreeWayCompare_WhenUsingKeysDifferingInCase_ThenTheyAreEquivalent)
+{
+  aisdi::TreeMap<std::string, int, CaseInsensitiveCompare> map;
+  map["Alice"] = 1;
+  map["bob"] = 2;
+  map["ALICE"] = 3;
+
+  BOOST_CHECK_EQUAL(map.getSize(), 2u);
+  BOOST_CHECK_EQUAL(map.valueOf("alice"), 3);
+  BOOST_CHECK_EQUAL(map.begin()->first, "Alice");
+
+  map.remove("BOB");
+
+  BOOST_CHECK(map.find("bob") == map.end());
+  BOOST_CHECK(map.freeze().contains("aLiCe"));
+}
+
+BOOST_AUTO_TEST_CASE(GivenTransparentCompare_WhenSearchingWithStringView_ThenItemIsFound)
+{
+  const aisdi::TreeMap<std::string, int, std::less<>> map = { { "Alice", 1 }, { "Bob", 2 } };
+
+  BOOST_CHECK_EQUAL(map.find(std::string_view("Bob"))->second, 2);
+  BOOST_CHECK_EQUAL(map.valueOf(std::string_view("Alice")), 1);
+  BOOST_CHECK(map.find(std::string_view("Chuck")) == map.end());
+}
+
+BOOST_AUTO_TEST_CASE(GivenLessThanCompare_WhenSearchingAndInserting_ThenOneComparisonPerLevelIsUsed)
+{
+  std::size_t comparisons = 0;
+  aisdi::TreeMap<int, int, CountingLess> map(CountingLess{ &comparisons });
+
+  for (int i = 0; i < 1023; ++i)
+  {
+    map[(i * 389) % 1023] = i;
+  }
+
+  // an AVL tree of 1023 items is at most 1.44 * log2(1024) = 14.4 levels high
+  for (int key = -1; key <= 1023; ++key)
+  {
+    comparisons = 0;
+    map.find(key);
+    BOOST_CHECK_LE(comparisons, 15u);
+
+    comparisons = 0;
+    map[key] = key;
+    BOOST_CHECK_LE(comparisons, 15u + 2u);
+  }
+}
+
+using BalancedMaps = boost::mpl::list<aisdi::TreeMap<int, std::string, std::less<int>, aisdi::AvlBalancing>,
+                                      aisdi::TreeMap<int, std::string, std::less<int>, aisdi::WavlBalancing>,
+                                      aisdi::TreeMap<int, std::string, std::less<int>, aisdi::RedBlackBalancing>,
+                                      aisdi::TreeMap<int, std::string, std::less<int>, aisdi::AvlBalancing, true>,
+                                      aisdi::TreeMap<int, std::string, std::less<int>, aisdi::RedBlackBalancing, true>>;
+
+template <typename Map>
+void thenMapMatchesModel(const Map& map, const std::map<int, std::string>& model)
+{
+  BOOST_REQUIRE_NO_THROW(map.checkInvariants());
+  BOOST_REQUIRE_EQUAL(map.getSize(), model.size());
+  BOOST_CHECK(std::equal(map.begin(), map.end(), model.begin(),
+                         [](const auto& a, const auto& b) { return a.first == b.first && a.second == b.second; }));
+
+  auto it = map.end();
+
+  for (auto expected = model.rbegin(); expected != model.rend(); ++expected)
+  {
+    --it;
+    BOOST_REQUIRE_EQUAL(it->first, expected->first);
+  }
+
+  BOOST_CHECK(it == map.begin());
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenBalancingPolicy_WhenMixingInsertsAndRemovals_ThenMapMatchesModel,
+                              Map,
+                              BalancedMaps)
+{
+  std::mt19937 random(17);
+  Map map;
+  std::map<int, std::string> model;
+
+  for (int i = 0; i < 30000; ++i)
+  {
+    int key = random() % 1000;
+
+    if (model.count(key) && random() % 2)
+    {
+      if (random() % 2)
+      {
+        map.remove(key);
+      }
+      else
+      {
+        map.remove(map.find(key));
+      }
+
+      model.erase(key);
+    }
+    else if (random() % 2)
+    {
+      map[key] = std::to_string(i);
+      model[key] = std::to_string(i);
+    }
+    else
+    {
+      map.insertHint(map.end(), key, std::to_string(i));
+      model[key] = std::to_string(i);
+    }
+
+    if (i % 97 == 0)
+    {
+      BOOST_REQUIRE_NO_THROW(map.checkInvariants());
+    }
+
+    if (i % 1009 == 0)
+    {
+      thenMapMatchesModel(map, model);
+    }
+  }
+
+  thenMapMatchesModel(map, model);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenBalancingPolicy_WhenUsingBulkOperations_ThenResultsMatchModel,
+                              Map,
+                              BalancedMaps)
+{
+  std::map<int, std::string> mine, theirs;
+
+  for (int i = 0; i < 300; ++i)
+  {
+    mine[(i * 7) % 500] = "mine";
+    theirs[(i * 11) % 600] = "theirs";
+  }
+
+  const Map mineMap(mine.begin(), mine.end());
+  const Map theirsMap(theirs.begin(), theirs.end());
+
+  Map united = mineMap;
+  united.unionWith(theirsMap);
+  std::map<int, std::string> expected = mine;
+  expected.insert(theirs.begin(), theirs.end());
+  thenMapMatchesModel(united, expected);
+
+  Map intersected = mineMap;
+  intersected.intersectWith(theirsMap);
+  expected.clear();
+
+  for (const auto& item : mine)
+  {
+    if (theirs.count(item.first))
+    {
+      expected.insert(item);
+    }
+  }
+
+  thenMapMatchesModel(intersected, expected);
+
+  expected = mine;
+  expected.insert(theirs.begin(), theirs.end());
+
+  Map greater = united.split(250);
+  thenMapMatchesModel(united, std::map<int, std::string>(expected.begin(), expected.lower_bound(250)));
+  thenMapMatchesModel(greater, std::map<int, std::string>(expected.lower_bound(250), expected.end()));
+
+  Map joined = Map::join(std::move(united), std::move(greater));
+  joined.remove(0);
+  joined[1000] = "new";
+
+  expected.erase(0);
+  expected[1000] = "new";
+  thenMapMatchesModel(joined, expected);
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenBalancingPolicy_WhenBuildingFromSorted_ThenTreeIsValidBeforeAndAfterUpdates,
+                              Map,
+                              BalancedMaps)
+{
+  aisdi::TaskPool pool(4);
+  std::vector<std::size_t> sizes = { 0, 1 };
+
+  for (std::size_t power : { 2, 4, 8, 16, 128, 8192 })
+  {
+    sizes.insert(sizes.end(), { power - 1, power, power + 1 });
+  }
+
+  for (std::size_t size : sizes)
+  {
+    BOOST_TEST_CONTEXT("size " << size)
+    {
+      std::vector<std::pair<int, std::string>> items;
+      std::map<int, std::string> model;
+
+      for (std::size_t i = 0; i < size; ++i)
+      {
+        items.emplace_back(2 * i, "even");
+        model[2 * i] = "even";
+      }
+
+      auto map = Map::fromSorted(items.begin(), items.end());
+      const auto parallel = Map::fromSorted(items.begin(), items.end(), pool);
+
+      thenMapMatchesModel(map, model);
+      thenMapMatchesModel(parallel, model);
+
+      for (std::size_t i = 0; i < size; i += 3)
+      {
+        map[2 * i + 1] = "odd";
+        model[2 * i + 1] = "odd";
+        map.remove(2 * i);
+        model.erase(2 * i);
+      }
+
+      map.insertHint(map.end(), 2 * size, "last");
+      model[2 * size] = "last";
+      map[-1] = "first";
+      model[-1] = "first";
+
+      thenMapMatchesModel(map, model);
+    }
+  }
+}
+
+BOOST_AUTO_TEST_CASE_TEMPLATE(GivenMap_WhenFindingManyKeys_ThenResultsMatchFind,
+                              Map,
+                              BalancedMaps)
+{
+  std::mt19937 random(23);
+  Map map;
+  const Map& constMap = map;
+  std::vector<int> keys = { 1, 2 };
+
+  auto results = constMap.findMany(keys.begin(), keys.end());
+
+  BOOST_REQUIRE_EQUAL(results.size(), 2u);
+  BOOST_CHECK(results[0] == constMap.end() && results[1] == constMap.end());
+
+  for (int i = 0; i < 5000; ++i)
+  {
+    map[2 * (random() % 4000)] = std::to_string(i);
+  }
+
+  keys.clear();
+
+  for (int i = 0; i < 3000; ++i)
+  {
+    keys.push_back(random() % 8002 - 1);
+  }
+
+  results = constMap.findMany(keys.begin(), keys.end());
+
+  BOOST_REQUIRE_EQUAL(results.size(), keys.size());
+
+  for (std::size_t i = 0; i < keys.size(); ++i)
+  {
+    BOOST_CHECK(results[i] == constMap.find(keys[i]));
+  }
+}
+
+BOOST_AUTO_TEST_CASE(GivenThreadedMap_WhenCopyingAndSplitting_ThenEachMapIteratesOnlyItsOwnItems)
+{
+  using ThreadedMap = aisdi::TreeMap<int, std::string, std::less<int>, aisdi::AvlBalancing, true>;
+
+  ThreadedMap map;
+
+  for (int i = 0; i < 100; ++i)
+  {
+    map[i] = std::to_string(i);
+  }
+
+  ThreadedMap copy = map;
+  map.clear();
+
+  ThreadedMap greater = copy.split(50);
+  greater.remove(50);
+
+  BOOST_CHECK_EQUAL(copy.begin()->first, 0);
+  BOOST_CHECK_EQUAL((--copy.end())->first, 49);
+  BOOST_CHECK(++copy.find(49) == copy.end());
+  BOOST_CHECK_EQUAL(greater.begin()->first, 51);
+  BOOST_CHECK(--greater.find(51) == greater.end());
+
+  ThreadedMap joined = ThreadedMap::join(std::move(copy), std::move(greater));
+
+  BOOST_CHECK_EQUAL(joined.getSize(), 99u);
+  BOOST_CHECK_EQUAL((++joined.find(49))->first, 51);
+  BOOST_CHECK_EQUAL((--joined.find(51))->first, 49);
+}
+
+BOOST_AUTO_TEST_CASE(GivenMapOfCountedKeys_WhenUsingSubscriptOperator_ThenComparisonsStayLogarithmic)
+{
+  using Key = aisdi::Counted<int>;
+
+  aisdi::TreeMap<Key, int> map;
+  const int size = 4095; // log2(size + 1) = 12
+
+  for (int i = 0; i < size; ++i)
+  {
+    map[(i * 1609) % size] = i;
+  }
+
+  std::uint64_t total = 0;
+
+  for (int i = 0; i < size; ++i)
+  {
+    const Key key = i;
+    aisdi::OperationCounts before = aisdi::OperationCounts::current();
+
+    map[key] = i;
+    aisdi::OperationCounts cost = aisdi::OperationCounts::current() - before;
+
+    // at most 1.44 * log2(size) levels and one comparison each, plus the final equality check
+    BOOST_CHECK_LE(cost.comparisons, 19u);
+    BOOST_CHECK_EQUAL(cost.copies + cost.moves, 0u);
+    total += cost.comparisons;
+  }
+
+  // the descent always reaches a leaf, then come the checks against both ends and for equality
+  BOOST_CHECK_LE(static_cast<double>(total) / size, 12 + 4);
+
+  aisdi::OperationCounts before = aisdi::OperationCounts::current();
+  map[Key(size)] = size;
+
+  BOOST_CHECK_EQUAL((aisdi::OperationCounts::current() - before).copies, 1u);
+}
+
 // ConstIterator is tested via Iterator methods.
 // If Iterator methods are to be changed, then new ConstIterator tests are required.
 